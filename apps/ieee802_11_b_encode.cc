@@ -0,0 +1,270 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2019 gr-ieee802_11_b author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * Offline batch encoder: reads PSDUs from a file of raw length-prefixed
+ * records or a pcap/pcapng capture of 802.11 frames and writes the baseband
+ * chips of their PPDUs, back to back, to an IQ file. Produces the same
+ * chips as tx_frame_encoder, without a flowgraph.
+ *
+ *   ieee802_11_b_encode [options] INPUT OUTPUT
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "frame_coder.h"
+#include "psdu_file.h"
+
+#include <getopt.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace gr::ieee802_11_b;
+
+// Chips encoded between writes; a maximum length PPDU always fits
+static const size_t BUFFER_CHIPS = 1 << 21;
+
+static void usage(const char *prog) {
+    std::fprintf(stderr,
+                 "usage: %s [options] INPUT OUTPUT\n"
+                 "  -m, --modulation M   DBPSK_1 (0), DQPSK_2 (1), CCK_5_5 (2) or CCK_11 (3)\n"
+                 "                       (default CCK_11)\n"
+                 "  -s, --short-sync     short preamble (not with DBPSK)\n"
+                 "  -i, --input FORMAT   auto, raw, pcap or pcapng (default auto)\n"
+                 "  -f, --format FORMAT  fc32 or sc16 output samples (default fc32)\n"
+                 "  -a, --amplitude A    sc16 amplitude as a fraction of full scale\n"
+                 "                       (default 1.0)\n"
+                 "  -g, --gap N          zero samples after every PPDU (default 0)\n",
+                 prog);
+}
+
+// The whole of arg as a number; false on anything else
+static bool parse_long(const char *arg, long &value) {
+    char *end;
+    errno = 0;
+    value = std::strtol(arg, &end, 10);
+    return end != arg && !*end && !errno;
+}
+
+static bool parse_float(const char *arg, float &value) {
+    char *end;
+    errno = 0;
+    value = std::strtof(arg, &end);
+    return end != arg && !*end && !errno && std::isfinite(value);
+}
+
+// A Modulation by number or enum name
+static bool parse_modulation(const std::string &arg, int &mod) {
+    static const char *NAMES[] = {"DBPSK_1", "DQPSK_2", "CCK_5_5", "CCK_11"};
+    for (int m = DBPSK_1; m <= CCK_11; ++m) {
+        if (arg == NAMES[m]) {
+            mod = m;
+            return true;
+        }
+    }
+    long value;
+    if (!parse_long(arg.c_str(), value) || value < DBPSK_1 || value > CCK_11)
+        return false;
+    mod = value;
+    return true;
+}
+
+class iq_writer {
+public:
+    iq_writer(const std::string &path, bool sc16, float amplitude)
+        : d_sc16(sc16),
+          d_scale(amplitude * 32767),
+          d_chips(BUFFER_CHIPS),
+          d_len(0),
+          d_written(0)
+    {
+        d_file = std::fopen(path.c_str(), "wb");
+        if (!d_file)
+            throw std::runtime_error("Cannot open " + path + ": " + std::strerror(errno));
+        if (sc16)
+            d_sc16_buf.resize(2 * BUFFER_CHIPS);
+    }
+
+    ~iq_writer() {
+        if (d_file)
+            std::fclose(d_file);
+    }
+
+    // Room for n more samples, flushing the buffer if needed
+    gr_complex *reserve(size_t n) {
+        if (d_len + n > d_chips.size())
+            flush();
+        return &d_chips[d_len];
+    }
+
+    void commit(size_t n) { d_len += n; }
+
+    void flush() {
+        if (d_sc16) {
+            for (size_t i = 0; i < d_len; ++i) {
+                d_sc16_buf[2 * i] = (int16_t) std::lround(d_scale * d_chips[i].real());
+                d_sc16_buf[2 * i + 1] = (int16_t) std::lround(d_scale * d_chips[i].imag());
+            }
+            write(d_sc16_buf.data(), d_len * 2 * sizeof(int16_t));
+        } else {
+            write(d_chips.data(), d_len * sizeof(gr_complex));
+        }
+        d_written += d_len;
+        d_len = 0;
+    }
+
+    void close() {
+        flush();
+        if (std::fclose(d_file) != 0)
+            throw std::runtime_error(std::string("Write failed: ") + std::strerror(errno));
+        d_file = nullptr;
+    }
+
+    uint64_t samples_written() const { return d_written; }
+
+private:
+    std::FILE *d_file;
+    bool d_sc16;
+    float d_scale;
+    std::vector<gr_complex> d_chips;
+    std::vector<int16_t> d_sc16_buf;
+    size_t d_len;
+    uint64_t d_written;
+
+    void write(const void *data, size_t n) {
+        if (std::fwrite(data, 1, n, d_file) != n)
+            throw std::runtime_error(std::string("Write failed: ") + std::strerror(errno));
+    }
+};
+
+int main(int argc, char **argv) {
+    static const struct option options[] = {
+        {"modulation", required_argument, nullptr, 'm'},
+        {"short-sync", no_argument, nullptr, 's'},
+        {"input", required_argument, nullptr, 'i'},
+        {"format", required_argument, nullptr, 'f'},
+        {"amplitude", required_argument, nullptr, 'a'},
+        {"gap", required_argument, nullptr, 'g'},
+        {"help", no_argument, nullptr, 'h'},
+        {nullptr, 0, nullptr, 0}
+    };
+
+    int mod = CCK_11;
+    bool short_sync = false;
+    psdu_file::file_format input = psdu_file::FORMAT_AUTO;
+    bool sc16 = false;
+    float amplitude = 1.0;
+    long gap = 0;
+
+    int c;
+    while ((c = getopt_long(argc, argv, "m:si:f:a:g:h", options, nullptr)) != -1) {
+        std::string arg = optarg ? optarg : "";
+        switch(c) {
+        case 'm':
+            if (!parse_modulation(arg, mod)) { usage(argv[0]); return 1; }
+            break;
+        case 's':
+            short_sync = true;
+            break;
+        case 'i':
+            if (arg == "auto") input = psdu_file::FORMAT_AUTO;
+            else if (arg == "raw") input = psdu_file::FORMAT_RAW;
+            else if (arg == "pcap") input = psdu_file::FORMAT_PCAP;
+            else if (arg == "pcapng") input = psdu_file::FORMAT_PCAPNG;
+            else { usage(argv[0]); return 1; }
+            break;
+        case 'f':
+            if (arg == "fc32") sc16 = false;
+            else if (arg == "sc16") sc16 = true;
+            else { usage(argv[0]); return 1; }
+            break;
+        case 'a':
+            if (!parse_float(optarg, amplitude)) { usage(argv[0]); return 1; }
+            break;
+        case 'g':
+            if (!parse_long(optarg, gap)) { usage(argv[0]); return 1; }
+            break;
+        default:
+            usage(argv[0]);
+            return c == 'h' ? 0 : 1;
+        }
+    }
+
+    if (argc - optind != 2 || gap < 0 ||
+        (sc16 && (amplitude < 0 || amplitude > 1))) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (short_sync && mod == DBPSK_1) {
+        std::fprintf(stderr, "Short Sync cannot be used with 1Mbps BPSK\n");
+        return 1;
+    }
+
+    try {
+        psdu_file in(argv[optind], input);
+        iq_writer out(argv[optind + 1], sc16, amplitude);
+        frame_coder coder(short_sync);
+
+        tx_frame frame;
+        q_phase phase{0};
+        uint64_t frames = 0;
+        const unsigned char *psdu;
+        int psdu_len;
+
+        auto t0 = std::chrono::steady_clock::now();
+        while (in.next(psdu, psdu_len)) {
+            coder.init_frame(frame, (Modulation) mod, psdu, psdu_len);
+            coder.scramble_psdu(frame);
+            phase = coder.encode(frame, phase, out.reserve(frame.n_chips));
+            out.commit(frame.n_chips);
+
+            for (long left = gap; left > 0; ) {
+                size_t n = std::min<size_t>(left, BUFFER_CHIPS);
+                std::fill_n(out.reserve(n), n, gr_complex(0, 0));
+                out.commit(n);
+                left -= n;
+            }
+            frames++;
+        }
+        out.close();
+        double seconds = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - t0).count();
+
+        std::fprintf(stderr, "%llu frames, %llu skipped, %llu samples in %.3f s (%.1f Msamples/s)\n",
+                     (unsigned long long) frames, (unsigned long long) in.skipped(),
+                     (unsigned long long) out.samples_written(), seconds,
+                     out.samples_written() / seconds / 1e6);
+    } catch (std::exception &e) {
+        std::fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
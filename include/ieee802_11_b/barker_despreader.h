@@ -0,0 +1,73 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2019 gr-ieee802_11_b author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_IEEE802_11_B_BARKER_DESPREADER_H
+#define INCLUDED_IEEE802_11_B_BARKER_DESPREADER_H
+
+#include <ieee802_11_b/api.h>
+#include <ieee802_11_b/psdu_mapper.h>
+#include <gnuradio/block.h>
+
+namespace gr {
+  namespace ieee802_11_b {
+
+    /*!
+     * \brief Despreads DBPSK/DQPSK Barker chips back to data bytes.
+     * \ingroup ieee802_11_b
+     *
+     * Inverse of code_mapper for DBPSK_1 and DQPSK_2. Takes one complex
+     * sample per chip, recovers the symbol timing with a Barker-11
+     * matched filter and outputs the differentially decoded bits packed
+     * LSB first, as code_mapper consumes them. The modulation is set at
+     * construction, with set_modulation, or by a "mod_change" tag on the
+     * chip where the new modulation starts.
+     * Nothing feeds the rate back from plcp_sync, whose tags only go
+     * downstream; see plcp_sync for what that means for the receive chain.
+     */
+    class IEEE802_11_B_API barker_despreader : virtual public gr::block
+    {
+     public:
+      typedef boost::shared_ptr<barker_despreader> sptr;
+
+      /*!
+       * \brief Return a shared_ptr to a new instance of ieee802_11_b::barker_despreader.
+       *
+       * To avoid accidental use of raw pointers, ieee802_11_b::barker_despreader's
+       * constructor is in a private implementation
+       * class. ieee802_11_b::barker_despreader::make is the public interface for
+       * creating new instances.
+       */
+      static sptr make(Modulation m = DBPSK_1);
+
+      virtual void set_modulation(Modulation m) = 0;
+      virtual Modulation modulation() const = 0;
+
+      //! Chip index modulo 11 at which symbols are currently sampled
+      virtual int chip_phase() const = 0;
+
+      //! Phase, in quarter turns, of the last decoded symbol; seeds
+      //! cck_demapper::set_reference_phase when the PSDU is CCK
+      virtual int reference_phase() const = 0;
+    };
+
+  } // namespace ieee802_11_b
+} // namespace gr
+
+#endif /* INCLUDED_IEEE802_11_B_BARKER_DESPREADER_H */
@@ -24,13 +24,31 @@
 #include <ieee802_11_b/api.h>
 #include <gnuradio/block.h>
 
+enum ChipFormat {
+    CHIPS_FC32 = 0,   // gr_complex
+    CHIPS_SC16 = 1,   // interleaved int16 I/Q
+    CHIPS_SC8  = 2,   // interleaved int8 I/Q
+    CHIPS_PHASE_PACKED = 3  // q_phase of four chips per byte, first chip in bits 0-1
+};
+
 namespace gr {
   namespace ieee802_11_b {
 
     /*!
-     * \brief <+description of block+>
+     * \brief Spreads bytes to Barker/CCK chips.
      * \ingroup ieee802_11_b
      *
+     * "mod_change" tags on the input switch the modulation. Chips are
+     * written in the given format with magnitude `amplitude`; for the
+     * fixed-point formats amplitude is a fraction of full scale.
+     * CHIPS_PHASE_PACKED outputs the 2-bit phase index (0: 1, 1: j, 2: -1,
+     * 3: -j) of every chip instead, which phase_expander turns back into
+     * samples; amplitude is ignored.
+     *
+     * The bytes marked by a "gap" tag from psdu_mapper become zero
+     * samples. The tag moves to the first of them, with the number of
+     * chips as its value; in CHIPS_PHASE_PACKED they are written as
+     * phase 0 and phase_expander zeroes them.
      */
     class IEEE802_11_B_API code_mapper : virtual public gr::block
     {
@@ -45,7 +63,35 @@ namespace gr {
        * class. ieee802_11_b::code_mapper::make is the public interface for
        * creating new instances.
        */
-      static sptr make( );
+      static sptr make(ChipFormat format = CHIPS_FC32, float amplitude = 1.0);
+
+      //! Turns the work call counters on or off; off by default
+      virtual void set_stats_enabled(bool enabled) = 0;
+      virtual bool stats_enabled() const = 0;
+
+      /*!
+       * \brief Work call counters, as described for psdu_mapper::stats();
+       * queue_depth counts the output items of a byte held back for the
+       * next call.
+       */
+      virtual pmt::pmt_t stats() const = 0;
+      virtual void reset_stats() = 0;
+
+      //! Post stats() on the "stats" port at most every interval seconds, 0 for never
+      virtual void set_stats_interval(double seconds) = 0;
+
+      /*!
+       * \brief Latency of the PPDUs traced by psdu_mapper.
+       *
+       * A "ppdu_time" tag moves to the first chip of its byte. When that
+       * chip is output, the time since the tag's stamp is recorded and a
+       * dictionary of offset (of the chip), ingress_ns and latency_ns is
+       * posted on the "latency" port. The summary holds count, mean_ns,
+       * min_ns and max_ns over all frames and p50_ns, p90_ns, p99_ns and
+       * p999_ns over the last 8192.
+       */
+      virtual pmt::pmt_t latency_summary() const = 0;
+      virtual void reset_latency() = 0;
     };
 
   } // namespace ieee802_11_b
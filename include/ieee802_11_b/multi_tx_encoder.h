@@ -0,0 +1,79 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2019 gr-ieee802_11_b author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_IEEE802_11_B_MULTI_TX_ENCODER_H
+#define INCLUDED_IEEE802_11_B_MULTI_TX_ENCODER_H
+
+#include <ieee802_11_b/api.h>
+#include <ieee802_11_b/psdu_mapper.h>
+#include <gnuradio/block.h>
+
+namespace gr {
+  namespace ieee802_11_b {
+
+    /*!
+     * \brief Encodes the PSDUs of several transmit channels to baseband chips.
+     * \ingroup ieee802_11_b
+     *
+     * Does the work of n_channels tx_frame_encoder blocks in one block.
+     * A message on the "psdu in" port is a pair of the channel number
+     * (an integer, or a dict with a "channel" entry) and the PSDU blob;
+     * messages for other channels and PSDUs longer than 4095 bytes are
+     * dropped.
+     *
+     * All channels share one chip clock: the block advances them in
+     * lock-step, one PSDU byte duration at a time, with the state of
+     * every channel in per-field arrays so that the scramblers run as
+     * SIMD lanes. A channel without a frame sends zeros while others
+     * are busy, and frames start on byte boundaries of that clock. The
+     * chips of a channel are otherwise those of tx_frame_encoder.
+     *
+     * The chips of channel c go to output c, or with interleaved to
+     * sample n_channels * k + c of the single output. A "ppdu_len" tag
+     * with the frame length in chips marks the first chip of every PPDU.
+     */
+    class IEEE802_11_B_API multi_tx_encoder : virtual public gr::block
+    {
+     public:
+      typedef boost::shared_ptr<multi_tx_encoder> sptr;
+
+      /*!
+       * \brief Return a shared_ptr to a new instance of ieee802_11_b::multi_tx_encoder.
+       *
+       * To avoid accidental use of raw pointers, ieee802_11_b::multi_tx_encoder's
+       * constructor is in a private implementation
+       * class. ieee802_11_b::multi_tx_encoder::make is the public interface for
+       * creating new instances.
+       *
+       * \param m PSDU modulation of every channel
+       * \param short_sync Short preamble and header
+       * \param n_channels Number of channels
+       * \param interleaved One output with the channels' chips interleaved
+       */
+      static sptr make(Modulation m, bool short_sync, int n_channels,
+                       bool interleaved = false);
+
+      //! Messages dropped for an invalid channel number or PSDU length
+      virtual uint64_t frames_dropped() const = 0;
+    };
+
+  } // namespace ieee802_11_b
+} // namespace gr
+
+#endif /* INCLUDED_IEEE802_11_B_MULTI_TX_ENCODER_H */
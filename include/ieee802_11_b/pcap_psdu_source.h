@@ -0,0 +1,79 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2019 gr-ieee802_11_b author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_IEEE802_11_B_PCAP_PSDU_SOURCE_H
+#define INCLUDED_IEEE802_11_B_PCAP_PSDU_SOURCE_H
+
+#include <ieee802_11_b/api.h>
+#include <gnuradio/block.h>
+
+#include <string>
+
+namespace gr {
+  namespace ieee802_11_b {
+
+    /*!
+     * \brief Replays the 802.11 frames of a capture file as PSDUs.
+     * \ingroup ieee802_11_b
+     *
+     * Memory-maps a pcap or pcapng file (or a file of raw records, a 16
+     * bit little-endian length followed by the PSDU) and posts every frame
+     * as a PDU on the "psdu out" port, ready for the "psdu in" port of
+     * psdu_mapper or tx_frame_encoder. Records that were truncated by the
+     * capture or are longer than a PSDU are skipped.
+     *
+     * Frames are sent frame_rate times per second, or as fast as the
+     * receivers take them when frame_rate is 0: a connected psdu_mapper
+     * or tx_frame_encoder is never sent more frames than it has free
+     * queue slots for, any other receiver holds at most a bounded number
+     * of unhandled messages.
+     */
+    class IEEE802_11_B_API pcap_psdu_source : virtual public gr::block
+    {
+     public:
+      typedef boost::shared_ptr<pcap_psdu_source> sptr;
+
+      /*!
+       * \brief Return a shared_ptr to a new instance of ieee802_11_b::pcap_psdu_source.
+       *
+       * To avoid accidental use of raw pointers, ieee802_11_b::pcap_psdu_source's
+       * constructor is in a private implementation
+       * class. ieee802_11_b::pcap_psdu_source::make is the public interface for
+       * creating new instances.
+       *
+       * \param filename Capture or raw PSDU file
+       * \param strip_radiotap Remove radiotap headers from the frames
+       * \param frame_rate Frames per second, 0 for as fast as possible
+       * \param repeat Start over at the end of the file
+       */
+      static sptr make(const std::string &filename, bool strip_radiotap = true,
+                       double frame_rate = 0, bool repeat = false);
+
+      //! PSDUs posted so far
+      virtual uint64_t frames_sent() const = 0;
+
+      //! Capture records skipped in the passes over the file completed so far
+      virtual uint64_t frames_skipped() const = 0;
+    };
+
+  } // namespace ieee802_11_b
+} // namespace gr
+
+#endif /* INCLUDED_IEEE802_11_B_PCAP_PSDU_SOURCE_H */
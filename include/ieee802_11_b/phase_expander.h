@@ -0,0 +1,60 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2019 gr-ieee802_11_b author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_IEEE802_11_B_PHASE_EXPANDER_H
+#define INCLUDED_IEEE802_11_B_PHASE_EXPANDER_H
+
+#include <ieee802_11_b/api.h>
+#include <ieee802_11_b/code_mapper.h>
+#include <gnuradio/sync_interpolator.h>
+
+namespace gr {
+  namespace ieee802_11_b {
+
+    /*!
+     * \brief Expands packed chip phases to samples.
+     * \ingroup ieee802_11_b
+     *
+     * Turns the CHIPS_PHASE_PACKED output of code_mapper back into four
+     * chips per input byte, in the given sample format and amplitude,
+     * with one table lookup per byte. Replaying a stored packed frame
+     * through it is equivalent to running code_mapper in that format,
+     * including the zero samples of the chips a "gap" tag marks.
+     */
+    class IEEE802_11_B_API phase_expander : virtual public gr::sync_interpolator
+    {
+     public:
+      typedef boost::shared_ptr<phase_expander> sptr;
+
+      /*!
+       * \brief Return a shared_ptr to a new instance of ieee802_11_b::phase_expander.
+       *
+       * To avoid accidental use of raw pointers, ieee802_11_b::phase_expander's
+       * constructor is in a private implementation
+       * class. ieee802_11_b::phase_expander::make is the public interface for
+       * creating new instances.
+       */
+      static sptr make(ChipFormat format = CHIPS_FC32, float amplitude = 1.0);
+    };
+
+  } // namespace ieee802_11_b
+} // namespace gr
+
+#endif /* INCLUDED_IEEE802_11_B_PHASE_EXPANDER_H */
@@ -0,0 +1,74 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2019 gr-ieee802_11_b author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_IEEE802_11_B_PLCP_SYNC_H
+#define INCLUDED_IEEE802_11_B_PLCP_SYNC_H
+
+#include <ieee802_11_b/api.h>
+#include <ieee802_11_b/psdu_mapper.h>
+#include <gnuradio/block.h>
+
+namespace gr {
+  namespace ieee802_11_b {
+
+    /*!
+     * \brief Finds PPDUs in a descrambled bitstream and extracts their PSDUs.
+     * \ingroup ieee802_11_b
+     *
+     * Searches the input, bits packed LSB first at any bit alignment, for
+     * the long or short preamble SFD. It then validates the PLCP header
+     * and publishes each PSDU on the "psdu out" port as a PDU with a
+     * blob, which psdu_mapper accepts unchanged. The metadata dict holds
+     * "modulation", "psdu_len" and "short_sync".
+     *
+     * The output carries the byte-aligned header and PSDU of every valid
+     * frame. "mod_change" tags mark where the header and the PSDU start.
+     *
+     * The tags only reach blocks downstream. barker_despreader and
+     * cck_demapper sit upstream and have already despread the PSDU by
+     * the time its header is checked here, so they cannot follow the
+     * rate of a frame. A barker_despreader -> scramble -> plcp_sync
+     * chain decodes at one fixed modulation. It only receives PPDUs
+     * whose preamble, header and PSDU all use it, i.e. long preamble
+     * DBPSK_1 frames.
+     */
+    class IEEE802_11_B_API plcp_sync : virtual public gr::block
+    {
+     public:
+      typedef boost::shared_ptr<plcp_sync> sptr;
+
+      /*!
+       * \brief Return a shared_ptr to a new instance of ieee802_11_b::plcp_sync.
+       *
+       * To avoid accidental use of raw pointers, ieee802_11_b::plcp_sync's
+       * constructor is in a private implementation
+       * class. ieee802_11_b::plcp_sync::make is the public interface for
+       * creating new instances.
+       */
+      static sptr make();
+
+      virtual uint64_t frames_received() const = 0;
+      virtual uint64_t header_errors() const = 0;
+    };
+
+  } // namespace ieee802_11_b
+} // namespace gr
+
+#endif /* INCLUDED_IEEE802_11_B_PLCP_SYNC_H */
@@ -51,8 +51,59 @@ namespace gr {
        * constructor is in a private implementation
        * class. ieee802_11_b::psdu_mapper::make is the public interface for
        * creating new instances.
+       *
+       * \param m Modulation of the PSDU
+       * \param short_sync Use the short preamble and header
+       * \param queue_depth Number of PPDUs that can wait to be sent
+       * \param max_batch Most PPDUs emitted per call to general_work
+       * \param gap_len Idle bytes inserted after every PPDU; a "gap" tag
+       *        with their count marks the first, so code_mapper sends them
+       *        as silence
+       */
+      static sptr make(Modulation m, bool short_sync, int queue_depth = 64,
+                       int max_batch = 16, int gap_len = 0);
+
+      //! Number of PPDU slots between "psdu in" and the output stream
+      virtual int queue_depth() const = 0;
+
+      //! PSDUs discarded because the queue was full or they were
+      //! longer than 4095 bytes
+      virtual uint64_t frames_dropped() const = 0;
+
+      //! PSDUs handled on "psdu in", queued or dropped
+      virtual uint64_t frames_received() const = 0;
+
+      //! Free PPDU slots; only grows unless a PSDU arrives
+      virtual int queue_space() const = 0;
+
+      //! Turns the work call counters on or off; off by default
+      virtual void set_stats_enabled(bool enabled) = 0;
+      virtual bool stats_enabled() const = 0;
+
+      /*!
+       * \brief Work call counters since they were enabled or reset.
+       *
+       * A dictionary of work_calls, items_in, items_out, ticks (TSC
+       * cycles on x86, nanoseconds elsewhere), ticks_per_item, tick_hz,
+       * queue_depth and queue_depth_max (PPDUs waiting to be sent after
+       * the last call) and ticks_per_call_log2_hist, whose entry i counts
+       * the calls that took [2^i, 2^(i+1)) ticks.
+       */
+      virtual pmt::pmt_t stats() const = 0;
+      virtual void reset_stats() = 0;
+
+      //! Post stats() on the "stats" port at most every interval seconds, 0 for never
+      virtual void set_stats_interval(double seconds) = 0;
+
+      /*!
+       * \brief Stamps PPDUs with the time their PSDU arrived.
+       *
+       * While on, the first byte of every PPDU also carries a "ppdu_time"
+       * tag with the arrival time on "psdu in" in nanoseconds of a
+       * monotonic clock, which code_mapper turns into latency reports.
        */
-      static sptr make(Modulation m, bool short_sync);
+      virtual void set_latency_tracing(bool enabled) = 0;
+      virtual bool latency_tracing() const = 0;
     };
 
   } // namespace ieee802_11_b
@@ -0,0 +1,65 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2019 gr-ieee802_11_b author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_IEEE802_11_B_PULSE_SHAPER_H
+#define INCLUDED_IEEE802_11_B_PULSE_SHAPER_H
+
+#include <ieee802_11_b/api.h>
+#include <gnuradio/sync_interpolator.h>
+
+#include <vector>
+
+namespace gr {
+  namespace ieee802_11_b {
+
+    /*!
+     * \brief Pulse shapes and interpolates a packed chip stream.
+     * \ingroup ieee802_11_b
+     *
+     * Takes the CHIPS_PHASE_PACKED output of code_mapper and applies the
+     * interpolating FIR filter `taps` at `sps` samples per chip, giving
+     * the same output as phase_expander followed by an interp_fir_filter.
+     * Since every chip is one of four points, the filter response to each
+     * group of four chips is precomputed, and an output sample costs one
+     * table lookup per four chips of filter span. The filter may span at
+     * most 32 chips.
+     */
+    class IEEE802_11_B_API pulse_shaper : virtual public gr::sync_interpolator
+    {
+     public:
+      typedef boost::shared_ptr<pulse_shaper> sptr;
+
+      /*!
+       * \brief Return a shared_ptr to a new instance of ieee802_11_b::pulse_shaper.
+       *
+       * To avoid accidental use of raw pointers, ieee802_11_b::pulse_shaper's
+       * constructor is in a private implementation
+       * class. ieee802_11_b::pulse_shaper::make is the public interface for
+       * creating new instances.
+       */
+      static sptr make(int sps, const std::vector<float> &taps);
+
+      virtual std::vector<float> taps() const = 0;
+    };
+
+  } // namespace ieee802_11_b
+} // namespace gr
+
+#endif /* INCLUDED_IEEE802_11_B_PULSE_SHAPER_H */
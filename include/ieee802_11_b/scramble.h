@@ -46,6 +46,20 @@ namespace gr {
        * creating new instances.
        */
       static sptr make(bool reverse);
+
+      //! Turns the work call counters on or off; off by default
+      virtual void set_stats_enabled(bool enabled) = 0;
+      virtual bool stats_enabled() const = 0;
+
+      /*!
+       * \brief Work call counters, as described for psdu_mapper::stats();
+       * queue_depth is always 0.
+       */
+      virtual pmt::pmt_t stats() const = 0;
+      virtual void reset_stats() = 0;
+
+      //! Post stats() on the "stats" port at most every interval seconds, 0 for never
+      virtual void set_stats_interval(double seconds) = 0;
     };
 
   } // namespace ieee802_11_b
@@ -0,0 +1,82 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2019 gr-ieee802_11_b author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_IEEE802_11_B_TX_FRAME_ENCODER_H
+#define INCLUDED_IEEE802_11_B_TX_FRAME_ENCODER_H
+
+#include <ieee802_11_b/api.h>
+#include <ieee802_11_b/psdu_mapper.h>
+#include <gnuradio/block.h>
+
+namespace gr {
+  namespace ieee802_11_b {
+
+    /*!
+     * \brief Encodes PSDUs straight to baseband chips.
+     * \ingroup ieee802_11_b
+     *
+     * Equivalent to psdu_mapper -> scramble -> code_mapper, but each PSDU
+     * received on the "psdu in" port is framed, scrambled and spread in a
+     * single pass without intermediate byte streams. A "ppdu_len" tag
+     * with the frame length in chips marks the first chip of every PPDU.
+     *
+     * With n_threads > 0, frames are scrambled and spread by that many
+     * worker threads in parallel and put back in order on the output,
+     * which is identical to the single-threaded one.
+     *
+     * At most queue_depth frames wait to be sent; PSDUs arriving while
+     * the queue is full are dropped. With worker threads every queued
+     * frame holds its spread chips, so the depth is further capped at
+     * 4 * n_threads.
+     */
+    class IEEE802_11_B_API tx_frame_encoder : virtual public gr::block
+    {
+     public:
+      typedef boost::shared_ptr<tx_frame_encoder> sptr;
+
+      /*!
+       * \brief Return a shared_ptr to a new instance of ieee802_11_b::tx_frame_encoder.
+       *
+       * To avoid accidental use of raw pointers, ieee802_11_b::tx_frame_encoder's
+       * constructor is in a private implementation
+       * class. ieee802_11_b::tx_frame_encoder::make is the public interface for
+       * creating new instances.
+       */
+      static sptr make(Modulation m, bool short_sync, int queue_depth = 64,
+                       int n_threads = 0);
+
+      //! Number of frames that can wait to be sent
+      virtual int queue_depth() const = 0;
+
+      //! PSDUs discarded because the queue was full or they were
+      //! longer than 4095 bytes
+      virtual uint64_t frames_dropped() const = 0;
+
+      //! PSDUs handled on "psdu in", queued or dropped
+      virtual uint64_t frames_received() const = 0;
+
+      //! Free frame slots; only grows unless a PSDU arrives
+      virtual int queue_space() const = 0;
+    };
+
+  } // namespace ieee802_11_b
+} // namespace gr
+
+#endif /* INCLUDED_IEEE802_11_B_TX_FRAME_ENCODER_H */
@@ -0,0 +1,170 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2019 gr-ieee802_11_b author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gnuradio/io_signature.h>
+#include "barker_despreader_impl.h"
+#include "chip_mapper.h"
+
+#include <volk/volk.h>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+// Weight of the newest symbol in the per-phase energy average
+#define ENERGY_ALPHA 0.0625f
+// A phase must beat the tracked one by this factor to take over
+#define PHASE_HYSTERESIS 1.5f
+
+namespace gr {
+    namespace ieee802_11_b {
+
+        barker_despreader::sptr
+        barker_despreader::make(Modulation m)
+        {
+            return gnuradio::get_initial_sptr
+                (new barker_despreader_impl(m));
+        }
+
+        barker_despreader_impl::barker_despreader_impl(Modulation m)
+            : gr::block("barker_despreader",
+                        gr::io_signature::make(1, 1, sizeof(gr_complex)),
+                        gr::io_signature::make(1, 1, sizeof(unsigned char))),
+            d_phase(0),
+            d_prev(1, 0),
+            d_byte(0),
+            d_n_bits(0)
+        {
+            set_modulation(m);
+
+            for (int c = 0; c < BARKER_LEN; ++c) {
+                d_taps[c] = chip_mapper::BARKER[c];
+                d_energy[c] = 0;
+            }
+            // Invert the transmitter's Gray mapping
+            for (int s = 0; s < 4; ++s)
+                d_dqpsk_symbols[chip_mapper::dqpsk_symbol_to_phase(s, true).ph] = s;
+
+            set_tag_propagation_policy(block::TPP_DONT);
+        }
+
+        barker_despreader_impl::~barker_despreader_impl()
+        {
+        }
+
+        void barker_despreader_impl::set_modulation(Modulation m) {
+            if (m != DBPSK_1 && m != DQPSK_2)
+                throw std::runtime_error("barker_despreader only supports DBPSK_1 and DQPSK_2");
+            d_modulation = m;
+        }
+
+        void
+        barker_despreader_impl::forecast (int noutput_items, gr_vector_int &ninput_items_required)
+        {
+            ninput_items_required[0] = noutput_items * chip_mapper::CHIPS_PER_BYTE[d_modulation]
+                + BARKER_WINDOW - BARKER_LEN;
+        }
+
+        int barker_despreader_impl::quadrant(gr_complex x) {
+            if (std::abs(x.real()) >= std::abs(x.imag()))
+                return x.real() >= 0 ? 0 : 2;
+            return x.imag() >= 0 ? 1 : 3;
+        }
+
+        int barker_despreader_impl::decode_symbol(gr_complex corr) const {
+            gr_complex diff = corr * std::conj(d_prev);
+            if (d_modulation == DBPSK_1)
+                return diff.real() < 0;
+            return d_dqpsk_symbols[quadrant(diff)];
+        }
+
+        int
+        barker_despreader_impl::general_work (int noutput_items,
+                                              gr_vector_int &ninput_items,
+                                              gr_vector_const_void_star &input_items,
+                                              gr_vector_void_star &output_items)
+        {
+            const gr_complex *in = (const gr_complex *) input_items[0];
+            unsigned char *out = (unsigned char *) output_items[0];
+
+            uint64_t s_offset = nitems_read(0);
+            get_tags_in_range(d_tags, 0, s_offset, s_offset + ninput_items[0],
+                              pmt::mp("mod_change"));
+            std::sort(d_tags.begin(), d_tags.end(), gr::tag_t::offset_compare);
+
+            // Every call starts on a symbol boundary of the tracked phase
+            int i = 0, o = 0;
+            size_t tags_idx = 0;
+            while (o < noutput_items && i + BARKER_WINDOW <= ninput_items[0]) {
+                while (tags_idx < d_tags.size() && d_tags[tags_idx].offset <= s_offset + i)
+                    set_modulation((Modulation) pmt::to_long(d_tags[tags_idx++].value));
+
+                // Matched filter at this symbol and the next BARKER_LEN - 1
+                // chip phases
+                gr_complex corr[BARKER_LEN];
+                for (int k = 0; k < BARKER_LEN; ++k)
+                    volk_32fc_32f_dot_prod_32fc(&corr[k], in + i + k, d_taps, BARKER_LEN);
+
+                int symbol = decode_symbol(corr[0]);
+                d_prev = corr[0];
+
+                int bits_per_symbol = d_modulation == DBPSK_1 ? 1 : 2;
+                for (int b = 0; b < bits_per_symbol; ++b) {
+                    d_byte |= ((symbol >> b) & 0x01) << d_n_bits;
+                    if (++d_n_bits == 8) {
+                        out[o++] = d_byte;
+                        d_byte = 0;
+                        d_n_bits = 0;
+                    }
+                }
+
+                // Track the chip phase with the most matched filter energy
+                int best = d_phase;
+                for (int k = 0; k < BARKER_LEN; ++k) {
+                    int ph = (d_phase + k) % BARKER_LEN;
+                    d_energy[ph] += ENERGY_ALPHA * (std::norm(corr[k]) - d_energy[ph]);
+                    if (d_energy[ph] > d_energy[best]) best = ph;
+                }
+
+                int step = BARKER_LEN;
+                if (best != d_phase && d_energy[best] > PHASE_HYSTERESIS * d_energy[d_phase]) {
+                    step = (best - d_phase + BARKER_LEN) % BARKER_LEN;
+                    d_phase = best;
+                    // Less than half a symbol ahead, the window just
+                    // decoded was mostly the symbol starting there: skip
+                    // it and take its aligned output as the reference
+                    if (step <= BARKER_LEN / 2) {
+                        d_prev = corr[step];
+                        step += BARKER_LEN;
+                    }
+                }
+                i += step;
+            }
+
+            consume_each(i);
+            return o;
+        }
+
+    } /* namespace ieee802_11_b */
+} /* namespace gr */
@@ -0,0 +1,81 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2019 gr-ieee802_11_b author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_IEEE802_11_B_BARKER_DESPREADER_IMPL_H
+#define INCLUDED_IEEE802_11_B_BARKER_DESPREADER_IMPL_H
+
+#include "common.h"
+#include <ieee802_11_b/barker_despreader.h>
+
+#include <vector>
+
+#define BARKER_LEN 11
+// Chips needed to correlate one symbol at all BARKER_LEN chip phases
+#define BARKER_WINDOW (2 * BARKER_LEN - 1)
+
+namespace gr {
+    namespace ieee802_11_b {
+
+        class barker_despreader_impl : public barker_despreader
+        {
+        public:
+            barker_despreader_impl(Modulation m);
+            ~barker_despreader_impl();
+
+            // Where all the action really happens
+            void forecast (int noutput_items, gr_vector_int &ninput_items_required);
+
+            int general_work(int noutput_items,
+                             gr_vector_int &ninput_items,
+                             gr_vector_const_void_star &input_items,
+                             gr_vector_void_star &output_items);
+
+            void set_modulation(Modulation m);
+            Modulation modulation() const { return d_modulation; }
+            int chip_phase() const { return d_phase; }
+            int reference_phase() const { return quadrant(d_prev); }
+
+        private:
+            Modulation d_modulation;
+
+            // Matched filter taps, chip_mapper::BARKER as floats
+            float d_taps[BARKER_LEN];
+            // Smoothed matched filter energy per chip phase
+            float d_energy[BARKER_LEN];
+            int d_phase;
+
+            // Matched filter output of the previous symbol
+            gr_complex d_prev;
+            // Phase quadrant between two symbols -> DQPSK symbol
+            unsigned char d_dqpsk_symbols[4];
+
+            unsigned char d_byte;
+            int d_n_bits;
+
+            std::vector<gr::tag_t> d_tags;
+
+            static int quadrant(gr_complex x);
+            int decode_symbol(gr_complex corr) const;
+        };
+
+    } // namespace ieee802_11_b
+} // namespace gr
+
+#endif /* INCLUDED_IEEE802_11_B_BARKER_DESPREADER_IMPL_H */
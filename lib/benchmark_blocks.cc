@@ -0,0 +1,517 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2019 gr-ieee802_11_b author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * Drives the work functions of the blocks directly, without a scheduler,
+ * and reports one record per (block, modulation, PSDU size, buffer size),
+ * code_mapper and phase_expander once per chip format and pulse_shaper
+ * at 4 and 8 samples per chip, tx_frame_encoder with 0 and 4 worker threads,
+ * multi_tx_encoder with 8 interleaved channels (buffer rounded up to whole
+ * ticks), and the bulk scrambler API on the whole stream with 1 and 4 threads
+ * (reported with buffer_items 0):
+ *
+ *   ieee802_11_b_benchmark [--format json|csv] [--bytes N]
+ *
+ * Each block gets a block_detail with real buffers so that tags and
+ * nitems_read/nitems_written behave as in a flowgraph, but the work
+ * functions read and write preallocated arrays. Allocations are counted
+ * through the global operator new over the timed region only.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gnuradio/block_detail.h>
+#include <gnuradio/buffer.h>
+
+#include "code_mapper_impl.h"
+#include "multi_tx_encoder_impl.h"
+#include "phase_expander_impl.h"
+#include "plcp.h"
+#include "psdu_mapper_impl.h"
+#include "pulse_shaper_impl.h"
+#include "scramble_impl.h"
+#include "scrambler.h"
+#include "tx_frame_encoder_impl.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+static std::atomic<uint64_t> g_allocs(0);
+
+void *operator new(size_t size) {
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    void *p = std::malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void *p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void *p, size_t) noexcept {
+    std::free(p);
+}
+
+namespace gr {
+    namespace ieee802_11_b {
+
+        static const char *MOD_NAMES[] = {"DBPSK_1", "DQPSK_2", "CCK_5_5", "CCK_11"};
+        static const int PSDU_SIZES[] = {64, 512, 1500, 4095};
+        static const int BUFFER_SIZES[] = {256, 4096, 65536};
+
+        struct bench_result {
+            std::string block;
+            std::string modulation;
+            int psdu_len;
+            int buffer_items;
+            uint64_t bytes;
+            uint64_t items_out;
+            double seconds;
+            uint64_t allocs;
+        };
+
+        /*
+         * Attaches a block_detail to blk with one input and/or one output
+         * buffer, and advances their counters the way the block executor
+         * would after each call.
+         */
+        class bench_harness {
+        public:
+            bench_harness(block_sptr blk, size_t in_size, size_t out_size)
+                : d_blk(blk)
+            {
+                d_detail = make_block_detail(in_size ? 1 : 0, 1);
+                if (in_size) {
+                    d_upstream = make_buffer(BUFFER_ITEMS, in_size);
+                    d_detail->set_input(0, buffer_add_reader(d_upstream, 0));
+                }
+                d_detail->set_output(0, make_buffer(BUFFER_ITEMS, out_size));
+                d_blk->set_detail(d_detail);
+            }
+
+            ~bench_harness() {
+                d_blk->set_detail(block_detail_sptr());
+            }
+
+            void add_input_tag(uint64_t offset, const pmt::pmt_t &key, const pmt::pmt_t &value) {
+                tag_t tag;
+                tag.offset = offset;
+                tag.key = key;
+                tag.value = value;
+                tag.srcid = pmt::PMT_F;
+                d_upstream->add_item_tag(tag);
+            }
+
+            int call(int noutput_items, int ninput_items,
+                     const void *in, void *out) {
+                gr_vector_int ninput(d_upstream ? 1 : 0, ninput_items);
+                gr_vector_const_void_star input_items(d_upstream ? 1 : 0, in);
+                gr_vector_void_star output_items(1, out);
+
+                int produced = d_blk->general_work(noutput_items, ninput,
+                                                   input_items, output_items);
+                d_detail->produce_each(produced);
+                if (d_upstream)
+                    d_upstream->prune_tags(d_detail->input(0)->nitems_read());
+                d_detail->output(0)->prune_tags(d_detail->output(0)->nitems_written());
+                return produced;
+            }
+
+        private:
+            static const int BUFFER_ITEMS = 1 << 16;
+
+            block_sptr d_blk;
+            block_detail_sptr d_detail;
+            buffer_sptr d_upstream;
+        };
+
+        static double now() {
+            return std::chrono::duration<double>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        // Concatenated PPDUs as produced by psdu_mapper, with their tags
+        struct ppdu_stream {
+            std::vector<unsigned char> bytes;
+            std::vector< std::pair<uint64_t, Modulation> > mod_tags;
+            std::vector<uint64_t> frame_starts;
+        };
+
+        static ppdu_stream make_stream(Modulation m, int psdu_len, uint64_t min_bytes) {
+            ppdu_stream s;
+            std::vector<unsigned char> psdu(psdu_len);
+            for (int i = 0; i < psdu_len; ++i)
+                psdu[i] = std::rand() & 0xFF;
+
+            int ppdu_len = ppdu_prefix_len(false) + psdu_len;
+            while (s.bytes.size() < min_bytes) {
+                uint64_t start = s.bytes.size();
+                std::vector< std::pair<int, Modulation> > tags;
+                s.bytes.resize(start + ppdu_len);
+                build_ppdu(m, false, psdu.data(), psdu_len, &s.bytes[start], tags);
+                s.frame_starts.push_back(start);
+                for (auto &t : tags)
+                    s.mod_tags.push_back({start + t.first, t.second});
+            }
+            return s;
+        }
+
+        static bench_result bench_scramble(bool reverse, const ppdu_stream &s,
+                                           int psdu_len, int buffer_items) {
+            boost::shared_ptr<scramble_impl> blk(new scramble_impl(reverse));
+            bench_harness h(blk, sizeof(char), sizeof(char));
+            const pmt::pmt_t len_key = pmt::mp("ppdu_len");
+            const pmt::pmt_t ppdu_len = pmt::from_long(ppdu_prefix_len(false) + psdu_len);
+            for (uint64_t start : s.frame_starts)
+                h.add_input_tag(start, len_key, ppdu_len);
+
+            std::vector<unsigned char> out(buffer_items);
+            uint64_t n = s.bytes.size(), pos = 0;
+
+            uint64_t allocs = g_allocs;
+            double t0 = now();
+            while (pos < n) {
+                int chunk = std::min<uint64_t>(buffer_items, n - pos);
+                pos += h.call(chunk, chunk, &s.bytes[pos], out.data());
+            }
+            double t1 = now();
+
+            return {reverse ? "descramble" : "scramble", "-", psdu_len, buffer_items,
+                    n, n, t1 - t0, g_allocs - allocs};
+        }
+
+        static bench_result bench_scrambler_bulk(bool reverse, int n_threads,
+                                                 const ppdu_stream &s, int psdu_len) {
+            chunk_pool pool(n_threads - 1);
+            scrambler scr(reverse);
+            std::vector<unsigned char> out(s.bytes.size());
+
+            uint64_t allocs = g_allocs;
+            double t0 = now();
+            scr.process_parallel(s.bytes.data(), out.data(), s.bytes.size(), pool);
+            double t1 = now();
+
+            return {std::string(reverse ? "descrambler_bulk_" : "scrambler_bulk_") +
+                    std::to_string(n_threads) + "t", "-", psdu_len, 0,
+                    s.bytes.size(), s.bytes.size(), t1 - t0, g_allocs - allocs};
+        }
+
+        static bench_result bench_code_mapper(Modulation m, ChipFormat format,
+                                              const ppdu_stream &s,
+                                              int psdu_len, int buffer_items,
+                                              bool stats = false) {
+            static const char *NAMES[] = {"code_mapper", "code_mapper_sc16", "code_mapper_sc8",
+                                          "code_mapper_packed"};
+            const size_t item_size = chip_mapper::chip_item_size(format);
+
+            boost::shared_ptr<code_mapper_impl> blk(new code_mapper_impl(format, 1.0f));
+            blk->set_stats_enabled(stats);
+            bench_harness h(blk, sizeof(char), item_size);
+            const pmt::pmt_t mod_key = pmt::mp("mod_change");
+            for (auto &t : s.mod_tags)
+                h.add_input_tag(t.first, mod_key, pmt::from_long(t.second));
+
+            std::vector<unsigned char> out(buffer_items * item_size);
+            uint64_t n = s.bytes.size(), chips = 0;
+            gr_vector_int required(1);
+
+            uint64_t allocs = g_allocs;
+            double t0 = now();
+            for (;;) {
+                uint64_t pos = blk->nitems_read(0);
+                if (pos == n) break;
+                // Mirror the scheduler: hand over what forecast asks for
+                blk->forecast(buffer_items, required);
+                int avail = std::min<uint64_t>(std::max(required[0], 1), n - pos);
+                chips += h.call(buffer_items, avail, &s.bytes[pos], out.data());
+            }
+            // Chips of the last byte held back in the carry
+            chips += h.call(buffer_items, 0, &s.bytes[n - 1], out.data());
+            double t1 = now();
+
+            return {std::string(NAMES[format]) + (stats ? "_stats" : ""), MOD_NAMES[m],
+                    psdu_len, buffer_items, n, chips, t1 - t0, g_allocs - allocs};
+        }
+
+        // Packed phases are any bytes, so the PPDU stream serves as input
+        static bench_result bench_phase_expander(ChipFormat format, const ppdu_stream &s,
+                                                 int psdu_len, int buffer_items) {
+            static const char *NAMES[] = {"phase_expander", "phase_expander_sc16",
+                                          "phase_expander_sc8"};
+            const size_t item_size = chip_mapper::chip_item_size(format);
+
+            boost::shared_ptr<phase_expander_impl> blk(new phase_expander_impl(format, 1.0f));
+            bench_harness h(blk, sizeof(char), item_size);
+
+            std::vector<unsigned char> out(buffer_items * item_size);
+            uint64_t n = s.bytes.size(), pos = 0, chips = 0;
+
+            uint64_t allocs = g_allocs;
+            double t0 = now();
+            while (pos < n) {
+                int chunk = std::min<uint64_t>(buffer_items / 4, n - pos);
+                int produced = h.call(4 * chunk, chunk, &s.bytes[pos], out.data());
+                chips += produced;
+                pos += produced / 4;
+            }
+            double t1 = now();
+
+            return {NAMES[format], "-", psdu_len, buffer_items,
+                    n, chips, t1 - t0, g_allocs - allocs};
+        }
+
+        // A filter spanning 8 chips, the same as a typical RRC
+        static bench_result bench_pulse_shaper(int sps, const ppdu_stream &s,
+                                               int psdu_len, int buffer_items) {
+            std::vector<float> taps(8 * sps + 1);
+            for (size_t i = 0; i < taps.size(); ++i)
+                taps[i] = std::rand() / (float) RAND_MAX;
+
+            boost::shared_ptr<pulse_shaper_impl> blk(new pulse_shaper_impl(sps, taps));
+            bench_harness h(blk, sizeof(char), sizeof(gr_complex));
+
+            std::vector<gr_complex> out(buffer_items);
+            const int per_byte = 4 * sps;
+            uint64_t n = s.bytes.size(), pos = 0, samples = 0;
+
+            uint64_t allocs = g_allocs;
+            double t0 = now();
+            while (pos < n) {
+                int chunk = std::min<uint64_t>(std::max(buffer_items / per_byte, 1), n - pos);
+                int produced = h.call(per_byte * chunk, chunk, &s.bytes[pos], out.data());
+                samples += produced;
+                pos += produced / per_byte;
+            }
+            double t1 = now();
+
+            return {sps == 4 ? "pulse_shaper_4x" : "pulse_shaper_8x", "-", psdu_len,
+                    buffer_items, n, samples, t1 - t0, g_allocs - allocs};
+        }
+
+        static bench_result bench_psdu_mapper(Modulation m, uint64_t min_bytes,
+                                              int psdu_len, int buffer_items) {
+            boost::shared_ptr<psdu_mapper_impl> blk(new psdu_mapper_impl(m, false, 64, 16, 0));
+            bench_harness h(blk, 0, sizeof(char));
+
+            std::vector<unsigned char> psdu(psdu_len);
+            for (int i = 0; i < psdu_len; ++i)
+                psdu[i] = std::rand() & 0xFF;
+            // One blob for every frame; psdu_mapper only holds a reference
+            pmt::pmt_t blob = pmt::make_blob(psdu.data(), psdu_len);
+
+            std::vector<unsigned char> out(buffer_items);
+            uint64_t ppdu_len = ppdu_prefix_len(false) + psdu_len;
+            uint64_t frames = std::max<uint64_t>(min_bytes / psdu_len, 1);
+            uint64_t queued = 0, written = 0, total = frames * ppdu_len;
+
+            uint64_t allocs = g_allocs;
+            double t0 = now();
+            while (written < total) {
+                // Keep the queue topped up without ever dropping a frame
+                while (queued < frames &&
+                       queued - written / ppdu_len < (uint64_t) blk->queue_depth()) {
+                    blk->psdu_in(blob);
+                    queued++;
+                }
+                written += h.call(buffer_items, 0, nullptr, out.data());
+            }
+            double t1 = now();
+
+            return {"psdu_mapper", MOD_NAMES[m], psdu_len, buffer_items,
+                    frames * psdu_len, total, t1 - t0, g_allocs - allocs};
+        }
+
+        static bench_result bench_tx_frame_encoder(Modulation m, int n_threads, uint64_t min_bytes,
+                                                   int psdu_len, int buffer_items) {
+            boost::shared_ptr<tx_frame_encoder_impl> blk(
+                new tx_frame_encoder_impl(m, false, 64, n_threads));
+            bench_harness h(blk, 0, sizeof(gr_complex));
+            blk->start();
+
+            std::vector<unsigned char> psdu(psdu_len);
+            for (int i = 0; i < psdu_len; ++i)
+                psdu[i] = std::rand() & 0xFF;
+            pmt::pmt_t blob = pmt::make_blob(psdu.data(), psdu_len);
+
+            std::vector<gr_complex> out(buffer_items);
+            uint64_t frames = std::max<uint64_t>(min_bytes / psdu_len, 1);
+            uint64_t frame_chips = ppdu_prefix_len(false) * chip_mapper::CHIPS_PER_BYTE[DBPSK_1] +
+                psdu_len * chip_mapper::CHIPS_PER_BYTE[m];
+            uint64_t queued = 0, chips = 0;
+
+            uint64_t allocs = g_allocs;
+            double t0 = now();
+            while (chips < frames * frame_chips) {
+                // Keep the queue topped up without ever dropping a frame
+                while (queued < frames && blk->queue_space() > 0) {
+                    blk->psdu_in(blob);
+                    queued++;
+                }
+                chips += h.call(buffer_items, 0, nullptr, out.data());
+            }
+            double t1 = now();
+            blk->stop();
+
+            return {n_threads ? "tx_frame_encoder_4t" : "tx_frame_encoder", MOD_NAMES[m],
+                    psdu_len, buffer_items, frames * psdu_len, chips, t1 - t0,
+                    g_allocs - allocs};
+        }
+
+        static bench_result bench_multi_tx_encoder(Modulation m, uint64_t min_bytes,
+                                                   int psdu_len, int buffer_items) {
+            const int n_channels = 8;
+            boost::shared_ptr<multi_tx_encoder_impl> blk(
+                new multi_tx_encoder_impl(m, false, n_channels, true));
+            bench_harness h(blk, 0, sizeof(gr_complex));
+
+            std::vector<unsigned char> psdu(psdu_len);
+            for (int i = 0; i < psdu_len; ++i)
+                psdu[i] = std::rand() & 0xFF;
+            pmt::pmt_t blob = pmt::make_blob(psdu.data(), psdu_len);
+
+            // Only whole ticks of every channel are produced
+            int tick = chip_mapper::CHIPS_PER_BYTE[m] * n_channels;
+            int noutput = (buffer_items + tick - 1) / tick * tick;
+            std::vector<gr_complex> out(noutput);
+            uint64_t frames = std::max<uint64_t>(min_bytes / psdu_len, n_channels);
+            uint64_t chips = 0;
+
+            uint64_t allocs = g_allocs;
+            double t0 = now();
+            for (uint64_t f = 0; f < frames; ++f)
+                blk->psdu_in(pmt::cons(pmt::from_long(f % n_channels), blob));
+            for (;;) {
+                int n = h.call(noutput, 0, nullptr, out.data());
+                if (n == 0) break;
+                chips += n;
+            }
+            double t1 = now();
+
+            return {"multi_tx_encoder_8ch", MOD_NAMES[m], psdu_len, buffer_items,
+                    frames * psdu_len, chips, t1 - t0, g_allocs - allocs};
+        }
+
+        static void print_results(const std::vector<bench_result> &results, bool csv) {
+            if (csv)
+                std::printf("block,modulation,psdu_len,buffer_items,bytes,items_out,"
+                            "seconds,bytes_per_s,items_per_s,ns_per_byte,allocs\n");
+            else
+                std::printf("[\n");
+
+            for (size_t i = 0; i < results.size(); ++i) {
+                const bench_result &r = results[i];
+                double bytes_per_s = r.bytes / r.seconds;
+                double items_per_s = r.items_out / r.seconds;
+                double ns_per_byte = r.seconds * 1e9 / r.bytes;
+                if (csv) {
+                    std::printf("%s,%s,%d,%d,%llu,%llu,%.6f,%.0f,%.0f,%.3f,%llu\n",
+                                r.block.c_str(), r.modulation.c_str(), r.psdu_len,
+                                r.buffer_items, (unsigned long long) r.bytes,
+                                (unsigned long long) r.items_out, r.seconds,
+                                bytes_per_s, items_per_s, ns_per_byte,
+                                (unsigned long long) r.allocs);
+                } else {
+                    std::printf("  {\"block\": \"%s\", \"modulation\": \"%s\", "
+                                "\"psdu_len\": %d, \"buffer_items\": %d, "
+                                "\"bytes\": %llu, \"items_out\": %llu, "
+                                "\"seconds\": %.6f, \"bytes_per_s\": %.0f, "
+                                "\"items_per_s\": %.0f, \"ns_per_byte\": %.3f, "
+                                "\"allocs\": %llu}%s\n",
+                                r.block.c_str(), r.modulation.c_str(), r.psdu_len,
+                                r.buffer_items, (unsigned long long) r.bytes,
+                                (unsigned long long) r.items_out, r.seconds,
+                                bytes_per_s, items_per_s, ns_per_byte,
+                                (unsigned long long) r.allocs,
+                                i + 1 < results.size() ? "," : "");
+                }
+            }
+
+            if (!csv)
+                std::printf("]\n");
+        }
+
+    } /* namespace ieee802_11_b */
+} /* namespace gr */
+
+int main(int argc, char **argv) {
+    using namespace gr::ieee802_11_b;
+
+    bool csv = false;
+    uint64_t min_bytes = 1 << 22;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--format" && i + 1 < argc &&
+            (std::string(argv[i + 1]) == "json" || std::string(argv[i + 1]) == "csv")) {
+            csv = std::string(argv[++i]) == "csv";
+        } else if (arg == "--bytes" && i + 1 < argc) {
+            min_bytes = std::strtoull(argv[++i], nullptr, 0);
+        } else {
+            std::fprintf(stderr, "usage: %s [--format json|csv] [--bytes N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    std::vector<bench_result> results;
+    for (int psdu_len : PSDU_SIZES) {
+        for (int m = DBPSK_1; m <= CCK_11; ++m) {
+            Modulation mod = (Modulation) m;
+            ppdu_stream s = make_stream(mod, psdu_len, min_bytes);
+            if (mod == DBPSK_1) {
+                for (bool reverse : {false, true}) {
+                    results.push_back(bench_scrambler_bulk(reverse, 1, s, psdu_len));
+                    results.push_back(bench_scrambler_bulk(reverse, 4, s, psdu_len));
+                }
+            }
+            for (int buffer_items : BUFFER_SIZES) {
+                // The scrambler does not depend on the modulation
+                if (mod == DBPSK_1) {
+                    results.push_back(bench_scramble(false, s, psdu_len, buffer_items));
+                    results.push_back(bench_scramble(true, s, psdu_len, buffer_items));
+                    for (int f = CHIPS_FC32; f <= CHIPS_SC8; ++f)
+                        results.push_back(bench_phase_expander((ChipFormat) f, s, psdu_len,
+                                                               buffer_items));
+                    results.push_back(bench_pulse_shaper(4, s, psdu_len, buffer_items));
+                    results.push_back(bench_pulse_shaper(8, s, psdu_len, buffer_items));
+                }
+                for (int f = CHIPS_FC32; f <= CHIPS_PHASE_PACKED; ++f)
+                    results.push_back(bench_code_mapper(mod, (ChipFormat) f, s, psdu_len, buffer_items));
+                // Cost of the work call counters
+                results.push_back(bench_code_mapper(mod, CHIPS_FC32, s, psdu_len, buffer_items, true));
+                results.push_back(bench_psdu_mapper(mod, min_bytes, psdu_len, buffer_items));
+                results.push_back(bench_tx_frame_encoder(mod, 0, min_bytes, psdu_len, buffer_items));
+                results.push_back(bench_tx_frame_encoder(mod, 4, min_bytes, psdu_len, buffer_items));
+                results.push_back(bench_multi_tx_encoder(mod, min_bytes, psdu_len, buffer_items));
+            }
+        }
+    }
+
+    print_results(results, csv);
+    return 0;
+}
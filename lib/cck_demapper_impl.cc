@@ -0,0 +1,232 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2019 gr-ieee802_11_b author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gnuradio/io_signature.h>
+#include "cck_demapper_impl.h"
+#include "chip_mapper.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+// x * exp(-j * p * pi / 2) = (COS[p] * re + SIN[p] * im, COS[p] * im - SIN[p] * re)
+static const float COS[4] = {1, 0, -1, 0};
+static const float SIN[4] = {0, 1, 0, -1};
+
+namespace gr {
+    namespace ieee802_11_b {
+
+        cck_demapper::sptr
+        cck_demapper::make(Modulation m)
+        {
+            return gnuradio::get_initial_sptr
+                (new cck_demapper_impl(m));
+        }
+
+        cck_demapper_impl::cck_demapper_impl(Modulation m)
+            : gr::block("cck_demapper",
+                        gr::io_signature::make(1, 1, sizeof(gr_complex)),
+                        gr::io_signature::make(1, 1, sizeof(unsigned char))),
+            d_prev_phase(0),
+            d_byte(0),
+            d_n_bits(0),
+            d_mod_key(pmt::mp("mod_change")),
+            d_ref_key(pmt::mp("ref_phase"))
+        {
+            build_tables();
+            set_modulation(m);
+            set_tag_propagation_policy(block::TPP_DONT);
+        }
+
+        cck_demapper_impl::~cck_demapper_impl()
+        {
+        }
+
+        void cck_demapper_impl::build_tables() {
+            // Each chip of a codeword carries phi1, a sign and a subset of
+            // phi2..phi4. Probe chip_mapper::cck_spread one phase at a time
+            // to find that subset, which is the chip's butterfly slot.
+            const q_phase zero{0}, quarter{1};
+            q_phase base[CCK_CHIPS], probe[3][CCK_CHIPS];
+            chip_mapper::cck_spread(zero, zero, zero, zero, base);
+            chip_mapper::cck_spread(zero, quarter, zero, zero, probe[0]);
+            chip_mapper::cck_spread(zero, zero, quarter, zero, probe[1]);
+            chip_mapper::cck_spread(zero, zero, zero, quarter, probe[2]);
+
+            int used = 0;
+            for (int c = 0; c < CCK_CHIPS; ++c) {
+                int slot = 0;
+                for (int p = 0; p < 3; ++p)
+                    if (probe[p][c].ph != base[c].ph) slot |= 1 << p;
+                if ((used & (1 << slot)) || base[c].ph % 2)
+                    throw std::runtime_error("CCK codewords do not form a Walsh-Hadamard structure");
+                used |= 1 << slot;
+                d_chip_slot[c] = slot;
+                d_chip_sign[c] = base[c].ph ? -1 : 1;
+            }
+
+            for (int m = CCK_5_5; m <= CCK_11; ++m) {
+                cck_symbols &syms = d_symbols[m - CCK_5_5];
+                syms.symbols.assign(4 * CCK_CODEWORDS, -1);
+                int n_symbols = m == CCK_5_5 ? 16 : 256;
+                for (int s = 0; s < n_symbols; ++s) {
+                    q_phase phases[4];
+                    chip_mapper::cck_symbol_to_phases((Modulation) m, s, phases);
+                    int cw = phases[1].ph | phases[2].ph << 2 | phases[3].ph << 4;
+                    if (std::find(syms.codewords.begin(), syms.codewords.end(), cw) == syms.codewords.end())
+                        syms.codewords.push_back(cw);
+                    syms.symbols[phases[0].ph | cw << 2] = s;
+                }
+            }
+        }
+
+        void cck_demapper_impl::set_modulation(Modulation m) {
+            if (m != CCK_5_5 && m != CCK_11)
+                throw std::runtime_error("cck_demapper only supports CCK_5_5 and CCK_11");
+            d_modulation = m;
+            d_symbol = 0;
+        }
+
+        void
+        cck_demapper_impl::forecast (int noutput_items, gr_vector_int &ninput_items_required)
+        {
+            ninput_items_required[0] = noutput_items * chip_mapper::CHIPS_PER_BYTE[d_modulation];
+        }
+
+        void cck_demapper_impl::correlate(const gr_complex *chips,
+                                          float *corr_re, float *corr_im) const {
+            // Chips in butterfly order, bit p of the slot selecting phi(p + 2)
+            float y_re[CCK_CHIPS], y_im[CCK_CHIPS];
+            for (int c = 0; c < CCK_CHIPS; ++c) {
+                y_re[d_chip_slot[c]] = d_chip_sign[c] * chips[c].real();
+                y_im[d_chip_slot[c]] = d_chip_sign[c] * chips[c].imag();
+            }
+
+            // phi2: s1[phi2 + 4 * (slot >> 1)]
+            float s1_re[16], s1_im[16];
+            for (int n = 0; n < 4; ++n) {
+                float a_re = y_re[2 * n], a_im = y_im[2 * n];
+                float b_re = y_re[2 * n + 1], b_im = y_im[2 * n + 1];
+                for (int p = 0; p < 4; ++p) {
+                    s1_re[p + 4 * n] = a_re + COS[p] * b_re + SIN[p] * b_im;
+                    s1_im[p + 4 * n] = a_im + COS[p] * b_im - SIN[p] * b_re;
+                }
+            }
+
+            // phi3: s2[phi2 + 4 * phi3 + 16 * (slot >> 2)]
+            float s2_re[32], s2_im[32];
+            for (int n = 0; n < 2; ++n) {
+                for (int p = 0; p < 4; ++p) {
+                    for (int q = 0; q < 4; ++q) {
+                        const int a = q + 8 * n, b = a + 4;
+                        s2_re[q + 4 * p + 16 * n] = s1_re[a] + COS[p] * s1_re[b] + SIN[p] * s1_im[b];
+                        s2_im[q + 4 * p + 16 * n] = s1_im[a] + COS[p] * s1_im[b] - SIN[p] * s1_re[b];
+                    }
+                }
+            }
+
+            // phi4: corr[phi2 + 4 * phi3 + 16 * phi4]
+            for (int p = 0; p < 4; ++p) {
+                for (int q = 0; q < 16; ++q) {
+                    corr_re[q + 16 * p] = s2_re[q] + COS[p] * s2_re[q + 16] + SIN[p] * s2_im[q + 16];
+                    corr_im[q + 16 * p] = s2_im[q] + COS[p] * s2_im[q + 16] - SIN[p] * s2_re[q + 16];
+                }
+            }
+        }
+
+        int cck_demapper_impl::decode_symbol(const gr_complex *chips) {
+            float corr_re[CCK_CODEWORDS], corr_im[CCK_CODEWORDS];
+            correlate(chips, corr_re, corr_im);
+
+            // Pick codeword and phi1 quadrant jointly
+            const cck_symbols &syms = d_symbols[d_modulation - CCK_5_5];
+            int best = syms.codewords[0];
+            float best_metric = -1;
+            for (int cw : syms.codewords) {
+                float metric = std::max(std::abs(corr_re[cw]), std::abs(corr_im[cw]));
+                if (metric > best_metric) {
+                    best_metric = metric;
+                    best = cw;
+                }
+            }
+
+            int phase;
+            if (std::abs(corr_re[best]) >= std::abs(corr_im[best]))
+                phase = corr_re[best] >= 0 ? 0 : 2;
+            else
+                phase = corr_im[best] >= 0 ? 1 : 3;
+
+            // Undo the pi rotation chip_mapper applies to odd CCK_5_5 symbols
+            int ref = d_prev_phase;
+            if (d_modulation == CCK_5_5 && (d_symbol % 2)) ref += 2;
+            d_prev_phase = phase;
+            d_symbol++;
+
+            return syms.symbols[((phase - ref + 8) % 4) | best << 2];
+        }
+
+        int
+        cck_demapper_impl::general_work (int noutput_items,
+                                         gr_vector_int &ninput_items,
+                                         gr_vector_const_void_star &input_items,
+                                         gr_vector_void_star &output_items)
+        {
+            const gr_complex *in = (const gr_complex *) input_items[0];
+            unsigned char *out = (unsigned char *) output_items[0];
+
+            uint64_t s_offset = nitems_read(0);
+            get_tags_in_range(d_tags, 0, s_offset, s_offset + ninput_items[0]);
+            std::sort(d_tags.begin(), d_tags.end(), gr::tag_t::offset_compare);
+
+            int i = 0, o = 0;
+            size_t tags_idx = 0;
+            while (o < noutput_items && i + CCK_CHIPS <= ninput_items[0]) {
+                for (; tags_idx < d_tags.size() && d_tags[tags_idx].offset <= s_offset + i; ++tags_idx) {
+                    const gr::tag_t &tag = d_tags[tags_idx];
+                    if (pmt::eq(tag.key, d_mod_key))
+                        set_modulation((Modulation) pmt::to_long(tag.value));
+                    else if (pmt::eq(tag.key, d_ref_key))
+                        set_reference_phase(pmt::to_long(tag.value));
+                }
+
+                int symbol = decode_symbol(in + i);
+                i += CCK_CHIPS;
+
+                int bits_per_symbol = d_modulation == CCK_5_5 ? 4 : 8;
+                for (int b = 0; b < bits_per_symbol; ++b) {
+                    d_byte |= ((symbol >> b) & 0x01) << d_n_bits;
+                    if (++d_n_bits == 8) {
+                        out[o++] = d_byte;
+                        d_byte = 0;
+                        d_n_bits = 0;
+                    }
+                }
+            }
+
+            consume_each(i);
+            return o;
+        }
+
+    } /* namespace ieee802_11_b */
+} /* namespace gr */
@@ -0,0 +1,94 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2019 gr-ieee802_11_b author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_IEEE802_11_B_CCK_DEMAPPER_IMPL_H
+#define INCLUDED_IEEE802_11_B_CCK_DEMAPPER_IMPL_H
+
+#include "common.h"
+#include <ieee802_11_b/cck_demapper.h>
+
+#include <vector>
+
+#define CCK_CHIPS 8
+// (phi2, phi3, phi4) combinations, indexed phi2 | phi3 << 2 | phi4 << 4
+#define CCK_CODEWORDS 64
+
+namespace gr {
+    namespace ieee802_11_b {
+
+        class cck_demapper_impl : public cck_demapper
+        {
+        public:
+            cck_demapper_impl(Modulation m);
+            ~cck_demapper_impl();
+
+            // Where all the action really happens
+            void forecast (int noutput_items, gr_vector_int &ninput_items_required);
+
+            int general_work(int noutput_items,
+                             gr_vector_int &ninput_items,
+                             gr_vector_const_void_star &input_items,
+                             gr_vector_void_star &output_items);
+
+            void set_modulation(Modulation m);
+            Modulation modulation() const { return d_modulation; }
+
+            void set_reference_phase(int ph) { d_prev_phase = ph & 3; }
+            int reference_phase() const { return d_prev_phase; }
+
+            /*
+             * Correlates 8 chips against every codeword with phi1 = 0.
+             * For the codeword that was sent, corr is 8 * exp(j * phi1).
+             */
+            void correlate(const gr_complex *chips, float *corr_re, float *corr_im) const;
+
+        private:
+            struct cck_symbols {
+                // Codewords the modulation uses
+                std::vector<int> codewords;
+                // phi1 change | codeword << 2 -> data symbol
+                std::vector<int> symbols;
+            };
+
+            Modulation d_modulation;
+            cck_symbols d_symbols[2];
+
+            // Butterfly input slot and sign of each received chip
+            int d_chip_slot[CCK_CHIPS];
+            float d_chip_sign[CCK_CHIPS];
+
+            int d_symbol;
+            int d_prev_phase;
+
+            unsigned char d_byte;
+            int d_n_bits;
+
+            std::vector<gr::tag_t> d_tags;
+            const pmt::pmt_t d_mod_key;
+            const pmt::pmt_t d_ref_key;
+
+            void build_tables();
+            int decode_symbol(const gr_complex *chips);
+        };
+
+    } // namespace ieee802_11_b
+} // namespace gr
+
+#endif /* INCLUDED_IEEE802_11_B_CCK_DEMAPPER_IMPL_H */
@@ -0,0 +1,252 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2019 gr-ieee802_11_b author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "chip_mapper.h"
+
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+gr_complex q_phase::to_complex() const {
+    static const gr_complex POINTS[4] {
+        gr_complex(1, 0), gr_complex(0, 1), gr_complex(-1, 0), gr_complex(0, -1)
+    };
+    return POINTS[ph];
+}
+
+q_phase q_phase::neg () const {
+    return {(ph + 2) % 4};
+}
+
+q_phase q_phase::operator + (const q_phase& o) const {
+    return {(ph + o.ph) % 4};
+}
+
+q_phase q_phase::operator - () const {
+    return {(4 - ph) % 4};
+}
+
+
+namespace gr {
+    namespace ieee802_11_b {
+
+        chip_mapper::chip_mapper()
+            : d_curr_mod(DBPSK_1),
+              d_curr_phase(q_phase{0})
+        {
+        }
+
+        void chip_mapper::set_modulation (Modulation m) {
+            d_curr_mod = m;
+        }
+
+        q_phase chip_mapper::dbpsk_symbol_to_phase (uint8_t symbol) {
+            return PHASES[2 * symbol];
+        }
+
+        q_phase chip_mapper::dqpsk_symbol_to_phase (uint8_t symbol,
+                                                         bool grey_coded) {
+            if (!grey_coded || symbol <= 1) return PHASES[symbol];
+            return PHASES[5 - symbol];
+        }
+
+
+        void chip_mapper::cck_symbol_to_phases(Modulation m, unsigned char symbol,
+                                               q_phase *phases) {
+            phases[0] = dqpsk_symbol_to_phase(symbol & 0x03, true);
+            if (m == CCK_5_5) {
+                uint8_t d2 = (symbol >> 2) & 0x01;
+                uint8_t d3 = (symbol >> 3) & 0x01;
+
+                phases[1] = d2 ? PHASES[3] : PHASES[1];
+                phases[2] = PHASES[0];
+                phases[3] = d3 ? PHASES[2] : PHASES[0];
+            } else {
+                phases[1] = dqpsk_symbol_to_phase((symbol >> 2) & 0x03, false);
+                phases[2] = dqpsk_symbol_to_phase((symbol >> 4) & 0x03, false);
+                phases[3] = dqpsk_symbol_to_phase(symbol >> 6, false);
+            }
+        }
+
+        void chip_mapper::barker_spread (q_phase curr, q_phase *chips) {
+            for (int s : BARKER) {
+	        if (s == -1) *chips++ = curr.neg();
+                else *chips++ = curr;
+            }
+        }
+        
+        void chip_mapper::cck_spread(q_phase curr, q_phase p2, q_phase p3, q_phase p4,
+                                          q_phase *chips) {
+            chips[0] = curr + p2 + p3 + p4;
+            chips[1] = curr + p3 + p4;
+            chips[2] = curr + p2 + p4;
+            chips[3] = (curr + p4).neg();
+            chips[4] = curr + p2 + p3;
+            chips[5] = curr + p3;
+            chips[6] = (curr + p2).neg();
+            chips[7] = curr;
+        }
+
+        chip_lut chip_mapper::build_lut (Modulation m) {
+            chip_lut lut;
+            switch(m) {
+            case DBPSK_1:
+                lut.symbol_bits = 1;
+                lut.n_chips = 11;
+                break;
+            case DQPSK_2:
+                lut.symbol_bits = 2;
+                lut.n_chips = 11;
+                break;
+            case CCK_5_5:
+                lut.symbol_bits = 4;
+                lut.n_chips = 8;
+                break;
+            case CCK_11:
+                lut.symbol_bits = 8;
+                lut.n_chips = 8;
+                break;
+            default:
+                throw std::runtime_error("How did you get here?");
+                break;
+            }
+
+            q_phase block[11];
+            for (int ph = 0; ph < 4; ++ph) {
+                for (int symbol = 0; symbol < (1 << lut.symbol_bits); ++symbol) {
+                    q_phase curr = PHASES[ph];
+                    switch(m) {
+                    case DBPSK_1:
+                        curr = curr + dbpsk_symbol_to_phase(symbol);
+                        barker_spread(curr, block);
+                        break;
+                    case DQPSK_2:
+                        curr = curr + dqpsk_symbol_to_phase(symbol, true);
+                        barker_spread(curr, block);
+                        break;
+                    case CCK_5_5:
+                    case CCK_11: {
+                        // Odd CCK_5_5 symbols are rotated by pi, which the
+                        // caller folds into the phase it looks up with.
+                        q_phase phases[4];
+                        cck_symbol_to_phases(m, symbol, phases);
+                        curr = curr + phases[0];
+                        cck_spread(curr, phases[1], phases[2], phases[3], block);
+                        break;
+                    }
+                    }
+                    lut.next_phase.push_back(curr.ph);
+                    uint32_t packed = 0;
+                    for (int c = 0; c < lut.n_chips; ++c) {
+                        lut.chips.push_back(block[c].to_complex());
+                        lut.phases.push_back(block[c].ph);
+                        packed |= (uint32_t) block[c].ph << (2 * c);
+                    }
+                    lut.packed_phases.push_back(packed);
+                }
+            }
+            return lut;
+        }
+
+        int chip_mapper::map_packed (const unsigned char *in, int n, unsigned char *out) {
+            switch(d_curr_mod) {
+            case DBPSK_1:
+                return map_run_packed<DBPSK_1>(in, n, out);
+            case DQPSK_2:
+                return map_run_packed<DQPSK_2>(in, n, out);
+            case CCK_5_5:
+                return map_run_packed<CCK_5_5>(in, n, out);
+            default:
+                return map_run_packed<CCK_11>(in, n, out);
+            }
+        }
+
+        size_t chip_mapper::chip_item_size (ChipFormat format) {
+            switch(format) {
+            case CHIPS_FC32:
+                return sizeof(gr_complex);
+            case CHIPS_SC16:
+                return sizeof(sc16_t);
+            case CHIPS_SC8:
+                return sizeof(sc8_t);
+            case CHIPS_PHASE_PACKED:
+                return sizeof(unsigned char);
+            default:
+                throw std::runtime_error("Unknown chip format");
+            }
+        }
+
+        void chip_mapper::phase_points (float amplitude, gr_complex *points) {
+            for (int ph = 0; ph < 4; ++ph)
+                points[ph] = amplitude * PHASES[ph].to_complex();
+        }
+
+        void chip_mapper::phase_points (float amplitude, sc16_t *points) {
+            for (int ph = 0; ph < 4; ++ph) {
+                gr_complex p = PHASES[ph].to_complex();
+                points[ph] = {(int16_t) std::lround(amplitude * 32767 * p.real()),
+                              (int16_t) std::lround(amplitude * 32767 * p.imag())};
+            }
+        }
+
+        void chip_mapper::phase_points (float amplitude, sc8_t *points) {
+            for (int ph = 0; ph < 4; ++ph) {
+                gr_complex p = PHASES[ph].to_complex();
+                points[ph] = {(int8_t) std::lround(amplitude * 127 * p.real()),
+                              (int8_t) std::lround(amplitude * 127 * p.imag())};
+            }
+        }
+
+        int chip_mapper::map (const unsigned char *in, int n, gr_complex *out) {
+            switch(d_curr_mod) {
+            case DBPSK_1:
+                return map_run<DBPSK_1>(in, n, out, LUTS[DBPSK_1].chips.data());
+            case DQPSK_2:
+                return map_run<DQPSK_2>(in, n, out, LUTS[DQPSK_2].chips.data());
+            case CCK_5_5:
+                return map_run<CCK_5_5>(in, n, out, LUTS[CCK_5_5].chips.data());
+            default:
+                return map_run<CCK_11>(in, n, out, LUTS[CCK_11].chips.data());
+            }
+        }
+
+        const std::vector<q_phase> chip_mapper::PHASES {
+            q_phase{0}, q_phase{1}, q_phase{2}, q_phase{3}
+        };
+
+        const std::vector<int> chip_mapper::BARKER {
+            1, -1, 1, 1, -1, 1, 1, 1, -1, -1, -1
+        };
+
+        const std::vector<int> chip_mapper::CHIPS_PER_BYTE {
+            88, 44, 16, 8
+        };
+
+        // Must follow PHASES and BARKER, which build_lut depends on
+        const std::vector<chip_lut> chip_mapper::LUTS {
+            build_lut(DBPSK_1), build_lut(DQPSK_2), build_lut(CCK_5_5), build_lut(CCK_11)
+        };
+        
+    } /* namespace ieee802_11_b */
+} /* namespace gr */
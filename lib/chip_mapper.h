@@ -0,0 +1,258 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2019 gr-ieee802_11_b author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_IEEE802_11_B_CHIP_MAPPER_H
+#define INCLUDED_IEEE802_11_B_CHIP_MAPPER_H
+
+#include "common.h"
+#include <ieee802_11_b/code_mapper.h>
+
+#include <cstring>
+#include <vector>
+
+#define MAX_CHIPS_PER_BYTE 88
+
+struct q_phase {
+    int ph;
+
+    gr_complex to_complex() const;
+
+    q_phase neg() const;
+    q_phase operator + (const q_phase& o) const;
+    q_phase operator - () const;
+};
+
+/*
+ * Precomputed chips for one modulation. Entry (p << symbol_bits) | s holds
+ * the complete Barker or CCK block emitted for data symbol s when the
+ * current phase is p, together with the resulting phase.
+ */
+struct chip_lut {
+    int symbol_bits;
+    int n_chips;
+    std::vector<int> next_phase;
+    std::vector<gr_complex> chips;
+    // q_phase::ph of every chip, same layout as chips
+    std::vector<unsigned char> phases;
+    // The phases of each entry packed two bits per chip, first chip lowest
+    std::vector<uint32_t> packed_phases;
+};
+
+// Interleaved fixed-point chip samples
+struct sc16_t {
+    int16_t i;
+    int16_t q;
+};
+
+struct sc8_t {
+    int8_t i;
+    int8_t q;
+};
+
+namespace gr {
+    namespace ieee802_11_b {
+
+        // Shape of the chip LUT of each modulation, fixed at compile time
+        template <Modulation M> struct modulation_traits;
+        template <> struct modulation_traits<DBPSK_1> {
+            static const int SYMBOL_BITS = 1;
+            static const int N_CHIPS = 11;
+        };
+        template <> struct modulation_traits<DQPSK_2> {
+            static const int SYMBOL_BITS = 2;
+            static const int N_CHIPS = 11;
+        };
+        template <> struct modulation_traits<CCK_5_5> {
+            static const int SYMBOL_BITS = 4;
+            static const int N_CHIPS = 8;
+        };
+        template <> struct modulation_traits<CCK_11> {
+            static const int SYMBOL_BITS = 8;
+            static const int N_CHIPS = 8;
+        };
+
+        /*
+         * Differential Barker/CCK spreading of a byte stream, one byte of
+         * chips per call. Shared by code_mapper and the fused encoders.
+         */
+        class chip_mapper
+        {
+        public:
+            static const std::vector<int> CHIPS_PER_BYTE;
+            // Barker-11 spreading sequence of DBPSK_1 and DQPSK_2
+            static const std::vector<int> BARKER;
+
+            static q_phase dqpsk_symbol_to_phase (unsigned char symbol,
+                                                  bool grey_coded);
+
+            /*
+             * CCK_5_5/CCK_11 data symbol -> phase change of the codeword
+             * (phases[0]) and its phi2, phi3, phi4 (phases[1..3])
+             */
+            static void cck_symbol_to_phases(Modulation m, unsigned char symbol,
+                                             q_phase *phases);
+
+            // Codeword for phi1 = curr and the given phi2..phi4
+            static void cck_spread(q_phase curr, q_phase p2, q_phase p3, q_phase p4,
+                                   q_phase *chips);
+
+            chip_mapper();
+
+            // Starts a new modulation segment
+            void set_modulation(Modulation m);
+
+            Modulation modulation() const { return d_curr_mod; }
+
+            // Differential phase the next symbol is relative to
+            q_phase phase() const { return d_curr_phase; }
+            void set_phase(q_phase ph) { d_curr_phase = ph; }
+
+            int chips_per_byte() const { return CHIPS_PER_BYTE[d_curr_mod]; }
+
+            // Writes the chips of one byte, returns the number written
+            int map_byte(unsigned char in, gr_complex *out) { return map(&in, 1, out); }
+
+            // Packs the chip phases of one byte four per output byte, first
+            // chip in the low bits; returns the number of bytes written
+            int map_byte_packed(unsigned char in, unsigned char *out) {
+                return map_packed(&in, 1, out);
+            }
+
+            // Output item size of a chip format
+            static size_t chip_item_size(ChipFormat format);
+
+            // The sample of each q_phase at the given amplitude; full scale
+            // is 32767 for sc16_t and 127 for sc8_t
+            static void phase_points(float amplitude, gr_complex *points);
+            static void phase_points(float amplitude, sc16_t *points);
+            static void phase_points(float amplitude, sc8_t *points);
+
+            // The chip LUT of m with every chip of phase ph replaced by points[ph]
+            template <typename T>
+            static std::vector<T> chip_table(Modulation m, const T *points) {
+                std::vector<T> table;
+                for (unsigned char ph : LUTS[m].phases)
+                    table.push_back(points[ph]);
+                return table;
+            }
+
+            // As map_byte, copying from tables[m] = chip_table(m, ...)
+            template <typename T>
+            int map_byte(unsigned char in, T *out, const std::vector<T> *tables) {
+                return map(&in, 1, out, tables);
+            }
+
+            // Writes the chips of n bytes, returns the number written
+            int map(const unsigned char *in, int n, gr_complex *out);
+
+            // As map, copying from tables[m] = chip_table(m, ...)
+            template <typename T>
+            int map(const unsigned char *in, int n, T *out, const std::vector<T> *tables) {
+                switch(d_curr_mod) {
+                case DBPSK_1:
+                    return map_run<DBPSK_1>(in, n, out, tables[DBPSK_1].data());
+                case DQPSK_2:
+                    return map_run<DQPSK_2>(in, n, out, tables[DQPSK_2].data());
+                case CCK_5_5:
+                    return map_run<CCK_5_5>(in, n, out, tables[CCK_5_5].data());
+                default:
+                    return map_run<CCK_11>(in, n, out, tables[CCK_11].data());
+                }
+            }
+
+            // As map_byte_packed for n bytes
+            int map_packed(const unsigned char *in, int n, unsigned char *out);
+
+            /*
+             * Spreads n bytes, all of modulation M (the current one), with
+             * the chips of table. The symbols per byte and chips per symbol
+             * are constants here, so the loops unroll and the copies inline.
+             */
+            template <Modulation M, typename T>
+            int map_run(const unsigned char *in, int n, T *out, const T *table) {
+                typedef modulation_traits<M> traits;
+                const int *next_phase = LUTS[M].next_phase.data();
+                int ph = d_curr_phase.ph;
+                for (int b = 0; b < n; ++b) {
+                    for (int s = 0; s < 8 / traits::SYMBOL_BITS; ++s) {
+                        int idx = lut_index<M>(ph, in[b], s);
+                        ph = next_phase[idx];
+                        std::memcpy(out, table + idx * traits::N_CHIPS,
+                                    traits::N_CHIPS * sizeof(T));
+                        out += traits::N_CHIPS;
+                    }
+                }
+                d_curr_phase = q_phase{ph};
+                return n * (8 / traits::SYMBOL_BITS) * traits::N_CHIPS;
+            }
+
+            // As map_run, packing the chip phases like map_byte_packed
+            template <Modulation M>
+            int map_run_packed(const unsigned char *in, int n, unsigned char *out) {
+                typedef modulation_traits<M> traits;
+                const int *next_phase = LUTS[M].next_phase.data();
+                const uint32_t *packed = LUTS[M].packed_phases.data();
+                int ph = d_curr_phase.ph;
+                unsigned char *start = out;
+                // Every modulation spreads a byte to a multiple of four chips
+                for (int b = 0; b < n; ++b) {
+                    uint64_t acc = 0;
+                    int n_bits = 0;
+                    for (int s = 0; s < 8 / traits::SYMBOL_BITS; ++s) {
+                        int idx = lut_index<M>(ph, in[b], s);
+                        ph = next_phase[idx];
+                        acc |= (uint64_t) packed[idx] << n_bits;
+                        n_bits += 2 * traits::N_CHIPS;
+                        for (; n_bits >= 8; n_bits -= 8, acc >>= 8)
+                            *out++ = acc & 0xFF;
+                    }
+                }
+                d_curr_phase = q_phase{ph};
+                return out - start;
+            }
+
+        private:
+            static const std::vector<q_phase> PHASES;
+            static const std::vector<chip_lut> LUTS;
+
+            Modulation d_curr_mod;
+            q_phase d_curr_phase;
+
+            // LUT entry of symbol s of byte when the current phase is ph.
+            // A byte holds an even number of CCK_5_5 symbols, so its odd
+            // symbols, which are rotated by pi, are the odd s.
+            template <Modulation M>
+            static int lut_index(int ph, unsigned int byte, int s) {
+                const int bits = modulation_traits<M>::SYMBOL_BITS;
+                if (M == CCK_5_5 && (s & 1))
+                    ph ^= 2;
+                return (ph << bits) | ((byte >> (s * bits)) & ((1 << bits) - 1));
+            }
+
+            static q_phase dbpsk_symbol_to_phase (unsigned char symbol);
+
+            static void barker_spread(q_phase curr, q_phase *chips);
+
+            static chip_lut build_lut(Modulation m);
+        };
+
+    } // namespace ieee802_11_b
+} // namespace gr
+
+#endif /* INCLUDED_IEEE802_11_B_CHIP_MAPPER_H */
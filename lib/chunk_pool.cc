@@ -0,0 +1,126 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2019 gr-ieee802_11_b author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "chunk_pool.h"
+
+#include <boost/bind.hpp>
+
+#include <exception>
+#include <stdexcept>
+
+namespace gr {
+    namespace ieee802_11_b {
+
+        chunk_pool::chunk_pool(int n_threads)
+            : d_n_threads(n_threads),
+              d_generation(0),
+              d_task(nullptr),
+              d_n_tasks(0),
+              d_next(0),
+              d_running(0),
+              d_stopping(false)
+        {
+            if (n_threads < 0)
+                throw std::runtime_error("Number of threads cannot be negative");
+
+            for (int i = 0; i < n_threads; ++i)
+                d_workers.create_thread(boost::bind(&chunk_pool::worker, this));
+        }
+
+        chunk_pool::~chunk_pool()
+        {
+            {
+                gr::thread::scoped_lock lock(d_mutex);
+                d_stopping = true;
+                d_start_cond.notify_all();
+            }
+            d_workers.join_all();
+        }
+
+        void chunk_pool::drain(gr::thread::scoped_lock &lock) {
+            while (d_next < d_n_tasks) {
+                int i = d_next++;
+                d_running++;
+                lock.unlock();
+                try {
+                    (*d_task)(i);
+                    lock.lock();
+                } catch (...) {
+                    // Keep the first error for run() and skip what is left
+                    lock.lock();
+                    if (!d_error)
+                        d_error = std::current_exception();
+                    d_next = d_n_tasks;
+                }
+                if (--d_running == 0 && d_next == d_n_tasks)
+                    d_done_cond.notify_all();
+            }
+        }
+
+        void chunk_pool::run(int n_tasks, const std::function<void(int)> &task) {
+            if (n_tasks <= 0) return;
+            if (d_n_threads == 0 || n_tasks == 1) {
+                for (int i = 0; i < n_tasks; ++i)
+                    task(i);
+                return;
+            }
+
+            gr::thread::scoped_lock lock(d_mutex);
+            d_task = &task;
+            d_n_tasks = n_tasks;
+            d_next = 0;
+            d_generation++;
+            d_start_cond.notify_all();
+
+            drain(lock);
+            while (d_running)
+                d_done_cond.wait(lock);
+            d_task = nullptr;
+            d_n_tasks = 0;
+            d_next = 0;
+
+            if (d_error) {
+                std::exception_ptr error = d_error;
+                d_error = nullptr;
+                std::rethrow_exception(error);
+            }
+        }
+
+        void chunk_pool::worker() {
+            uint64_t seen = 0;
+
+            gr::thread::scoped_lock lock(d_mutex);
+            for (;;) {
+                while (d_generation == seen && !d_stopping)
+                    d_start_cond.wait(lock);
+                if (d_stopping)
+                    return;
+
+                seen = d_generation;
+                drain(lock);
+            }
+        }
+
+    } /* namespace ieee802_11_b */
+} /* namespace gr */
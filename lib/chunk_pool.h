@@ -0,0 +1,77 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2019 gr-ieee802_11_b author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_IEEE802_11_B_CHUNK_POOL_H
+#define INCLUDED_IEEE802_11_B_CHUNK_POOL_H
+
+#include <gnuradio/thread/thread.h>
+
+#include <exception>
+#include <functional>
+
+namespace gr {
+    namespace ieee802_11_b {
+
+        /*
+         * Fixed set of worker threads running indexed tasks. run() hands
+         * out the indices [0, n) to the workers and the calling thread
+         * and returns once all tasks are done. One run() at a time. If a
+         * task throws, the tasks not yet started are skipped and run()
+         * rethrows the first exception once the others have finished.
+         */
+        class chunk_pool
+        {
+        public:
+            // n_threads workers besides the caller, 0 runs everything inline
+            explicit chunk_pool(int n_threads);
+            ~chunk_pool();
+
+            // Threads taking part in run(), the caller included
+            int size() const { return d_n_threads + 1; }
+
+            void run(int n_tasks, const std::function<void(int)> &task);
+
+        private:
+            int d_n_threads;
+            gr::thread::mutex d_mutex;
+            gr::thread::condition_variable d_start_cond;
+            gr::thread::condition_variable d_done_cond;
+            gr::thread::thread_group d_workers;
+
+            // Current batch: bumped for each run() so workers can tell a
+            // new batch from the one they already finished
+            uint64_t d_generation;
+            const std::function<void(int)> *d_task;
+            int d_n_tasks;
+            int d_next;
+            int d_running;
+            bool d_stopping;
+            std::exception_ptr d_error;
+
+            // Runs tasks of the current batch until none are left, called
+            // and returning with the lock held
+            void drain(gr::thread::scoped_lock &lock);
+
+            void worker();
+        };
+
+    } // namespace ieee802_11_b
+} // namespace gr
+
+#endif /* INCLUDED_IEEE802_11_B_CHUNK_POOL_H */
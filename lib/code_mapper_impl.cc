@@ -25,42 +25,63 @@
 #include <gnuradio/io_signature.h>
 #include "code_mapper_impl.h"
 
-
-gr_complex q_phase::to_complex() const {
-    return std::exp(gr_complex(0, PI / 2.0 * ph));
-}
-
-q_phase q_phase::neg () const {
-    return {(ph + 2) % 4};
-}
-
-q_phase q_phase::operator + (const q_phase& o) const {
-    return {(ph + o.ph) % 4};
-}
-
-q_phase q_phase::operator - () const {
-    return {(4 - ph) % 4};
-}
+#include <cstring>
+#include <stdexcept>
 
 
 namespace gr {
     namespace ieee802_11_b {
 
         code_mapper::sptr
-        code_mapper::make()
+        code_mapper::make(ChipFormat format, float amplitude)
         {
             return gnuradio::get_initial_sptr
-                (new code_mapper_impl());
+                (new code_mapper_impl(format, amplitude));
         }
 
-        code_mapper_impl::code_mapper_impl( )
+        code_mapper_impl::code_mapper_impl(ChipFormat format, float amplitude)
             : gr::block("code_mapper",
                         gr::io_signature::make(1, 1, sizeof(unsigned char)),
-                        gr::io_signature::make(1, 1, sizeof(gr_complex))),
-            d_curr_mod(DBPSK_1),
-            d_symbol(0),
-	    d_curr_phase(q_phase{0})
+                        gr::io_signature::make(1, 1, chip_mapper::chip_item_size(format))),
+            d_format(format),
+            d_item_size(chip_mapper::chip_item_size(format)),
+            d_chips_per_item(format == CHIPS_PHASE_PACKED ? 4 : 1),
+            d_carry_len(0),
+            d_carry_pos(0),
+            d_mod_key(pmt::mp("mod_change")),
+            d_time_key(pmt::mp("ppdu_time")),
+            d_gap_key(pmt::mp("gap")),
+            d_gap_remaining(0),
+            d_latency_port(pmt::mp("latency"))
         {
+            if ((format == CHIPS_SC16 || format == CHIPS_SC8) && (amplitude < 0 || amplitude > 1))
+                throw std::runtime_error("Fixed-point amplitude must be within [0, 1]");
+
+            gr_complex points_fc32[4];
+            sc16_t points_sc16[4];
+            sc8_t points_sc8[4];
+            chip_mapper::phase_points(amplitude, points_fc32);
+            chip_mapper::phase_points(amplitude, points_sc16);
+            chip_mapper::phase_points(amplitude, points_sc8);
+
+            for (int m = DBPSK_1; m <= CCK_11; ++m) {
+                switch(format) {
+                case CHIPS_SC16:
+                    d_tables_sc16[m] = chip_mapper::chip_table((Modulation) m, points_sc16);
+                    break;
+                case CHIPS_SC8:
+                    d_tables_sc8[m] = chip_mapper::chip_table((Modulation) m, points_sc8);
+                    break;
+                case CHIPS_FC32:
+                    d_tables_fc32[m] = chip_mapper::chip_table((Modulation) m, points_fc32);
+                    break;
+                default:
+                    break;
+                }
+            }
+
+            message_port_register_out(pmt::mp("stats"));
+            message_port_register_out(d_latency_port);
             set_tag_propagation_policy(block::TPP_DONT);
         }
 
@@ -72,120 +93,71 @@ namespace gr {
         void
         code_mapper_impl::forecast (int noutput_items, gr_vector_int &ninput_items_required)
         {
-            double div_factor;
-            switch(d_curr_mod) {
-            case DBPSK_1:
-                div_factor = 11.0;
-                break;
-            case DQPSK_2:
-                div_factor = 5.5;
-                break;
-            case CCK_5_5:
-                div_factor = 2;
-                break;
-            case CCK_11:
-                div_factor = 1;
-                break;
-            default:
-                throw std::runtime_error("How did you get here?");
-                break;
+            int items = noutput_items - (d_carry_len - d_carry_pos);
+            if (items <= 0) {
+                ninput_items_required[0] = 0;
+                return;
             }
-            ninput_items_required[0] = (int) ((1.0 + noutput_items) / div_factor);
-            /* <+forecast+> e.g. ninput_items_required[0] = noutput_items */
-        }
-
-        q_phase code_mapper_impl::dbpsk_symbol_to_phase (uint8_t symbol) {
-            return PHASES[2 * symbol];
-        }
 
-        q_phase code_mapper_impl::dqpsk_symbol_to_phase (uint8_t symbol,
-                                                         bool grey_coded) {
-            if (!grey_coded || symbol <= 1) return PHASES[symbol];
-            return PHASES[5 - symbol];
-        }
-
-
-        void code_mapper_impl::barker_spread () {
-            for (int s : BARKER) {
-	        if (s == -1) d_phase_buffer.push(d_curr_phase.neg());
-                else d_phase_buffer.push(d_curr_phase);
+            // Walk the modulation segments announced by already seen
+            // mod_change tags; a byte that only partially fits is carried.
+            uint64_t pos = nitems_read(0);
+            Modulation mod = d_mapper.modulation();
+            int n_bytes = 0;
+            for (auto& pending : d_pending_mods) {
+                int seg_items = (pending.first - pos) * items_per_byte(mod);
+                if (seg_items >= items) break;
+                items -= seg_items;
+                n_bytes += pending.first - pos;
+                pos = pending.first;
+                mod = pending.second;
             }
+            n_bytes += (items + items_per_byte(mod) - 1) / items_per_byte(mod);
+            ninput_items_required[0] = n_bytes;
         }
-        
-        void code_mapper_impl::cck_spread(q_phase p2, q_phase p3, q_phase p4) {
-            d_phase_buffer.push(d_curr_phase + p2 + p3 + p4);
-            d_phase_buffer.push(d_curr_phase + p3 + p4);
-            d_phase_buffer.push(d_curr_phase + p2 + p4);
-            d_phase_buffer.push((d_curr_phase + p4).neg());
-            d_phase_buffer.push(d_curr_phase + p2 + p3);
-            d_phase_buffer.push(d_curr_phase + p3);
-            d_phase_buffer.push((d_curr_phase + p2).neg());
-            d_phase_buffer.push(d_curr_phase);
-        }
-        
-        void code_mapper_impl::dbpsk_1_process_byte (uint8_t byte) {
-            for (int i = 0; i < 8; ++i) {
-                q_phase p = dbpsk_symbol_to_phase((byte >> i) & 0x01);
-                d_curr_phase = d_curr_phase + p;
-                barker_spread();
-                d_symbol++;
-            }
-        }
-        
-        void code_mapper_impl::dqpsk_2_process_byte (uint8_t byte) {
-            for (int i = 0; i < 8; i += 2) {
-                q_phase p = dqpsk_symbol_to_phase((byte >> i) & 0x03, true);
-                d_curr_phase = d_curr_phase + p;
-                barker_spread();
-                d_symbol++;
+
+        int code_mapper_impl::map_run (const unsigned char *in, int n, unsigned char *out) {
+            if (d_gap_remaining) {
+                // Idle bytes are sent as silence and leave the phase alone;
+                // all-zero bits are a zero sample, or phase 0 when packed
+                int items = n * items_per_byte(d_mapper.modulation());
+                std::memset(out, 0, items * d_item_size);
+                d_gap_remaining -= n;
+                return items;
             }
-        }
 
-        void code_mapper_impl::cck_5_5_process_byte (uint8_t byte) {
-            for (int i = 0; i < 8; i += 4) {
-                uint8_t cck_symbol = ((byte >> i) & 0x0F);
-                q_phase p = dqpsk_symbol_to_phase(cck_symbol & 0x03, true);
-                if (d_symbol % 2) p = p.neg();
-                d_curr_phase = d_curr_phase + p;
-                uint8_t d2 = (cck_symbol >> 2) & 0x01;
-                uint8_t d3 = (cck_symbol >> 3) & 0x01;
-
-                q_phase p2 = d2 ? PHASES[3] : PHASES[1];
-                q_phase p3 = PHASES[0];
-                q_phase p4 = d3 ? PHASES[2] : PHASES[0];
-
-                cck_spread(p2, p3, p4);
-                d_symbol++;
+            switch(d_format) {
+            case CHIPS_PHASE_PACKED:
+                return d_mapper.map_packed(in, n, out);
+            case CHIPS_SC16:
+                return d_mapper.map(in, n, (sc16_t *) out, d_tables_sc16);
+            case CHIPS_SC8:
+                return d_mapper.map(in, n, (sc8_t *) out, d_tables_sc8);
+            default:
+                return d_mapper.map(in, n, (gr_complex *) out, d_tables_fc32);
             }
         }
 
-        void code_mapper_impl::cck_11_process_byte (uint8_t byte) {
-            q_phase p = dqpsk_symbol_to_phase(byte & 0x03, true);
-            d_curr_phase = d_curr_phase + p;
-            q_phase p2 = dqpsk_symbol_to_phase((byte >> 2) & 0x03, false);
-            q_phase p3 = dqpsk_symbol_to_phase((byte >> 4) & 0x03, false);
-            q_phase p4 = dqpsk_symbol_to_phase(byte >> 6, false);
-
-            cck_spread(p2, p3, p4);
-            d_symbol++;
+        void code_mapper_impl::report_latency() {
+            // The chips leave when work returns
+            uint64_t now = latency_tracker::now_ns();
+            for (auto &frame : d_traced) {
+                uint64_t latency = d_latency.record(frame.second, now);
+                pmt::pmt_t record = pmt::make_dict();
+                record = pmt::dict_add(record, pmt::mp("offset"), pmt::from_uint64(frame.first));
+                record = pmt::dict_add(record, pmt::mp("ingress_ns"), pmt::from_uint64(frame.second));
+                record = pmt::dict_add(record, pmt::mp("latency_ns"), pmt::from_uint64(latency));
+                message_port_pub(d_latency_port, record);
+            }
         }
 
-        
-        void code_mapper_impl::process_byte (uint8_t in) {
-            switch(d_curr_mod) {
-            case DBPSK_1:
-                dbpsk_1_process_byte(in);
-                break;
-            case DQPSK_2:
-                dqpsk_2_process_byte(in);
-                break;
-            case CCK_5_5:
-                cck_5_5_process_byte(in);
-                break;
-            case CCK_11:
-                cck_11_process_byte(in);
-                break;
-            }
+        int code_mapper_impl::flush_carry (unsigned char *out, int noutput_items) {
+            int n = std::min(noutput_items, d_carry_len - d_carry_pos);
+            std::memcpy(out, d_carry + d_carry_pos * d_item_size, n * d_item_size);
+            d_carry_pos += n;
+            if (d_carry_pos == d_carry_len)
+                d_carry_len = d_carry_pos = 0;
+            return n;
         }
 
         int
@@ -195,48 +167,68 @@ namespace gr {
                                         gr_vector_void_star &output_items)
         {
             const unsigned char *in = (const unsigned char *) input_items[0];
-            gr_complex *out = (gr_complex *) output_items[1];
-
-            std::vector<gr::tag_t> tags;
-            int s_offset = nitems_read(0);
-            get_tags_in_range(tags, 0, s_offset, s_offset + ninput_items[0],
-                              pmt::mp("mod_change"));
-            
-            int mod_offset = -1, tags_idx = -1;
-            if (tags.size()) {
-                std::sort(tags.begin(), tags.end(), gr::tag_t::offset_compare);
-                mod_offset = tags[0].offset - s_offset;
-                ++tags_idx;
-            }
-            
-            int i = 0, o = 0;
-            while (true) {
-                while (o < noutput_items && d_phase_buffer.size()) {
-                    if (d_curr_mod == DBPSK_1 || d_curr_mod == DQPSK_2)
-		        out[o++] = d_phase_buffer.front().to_complex();
-                    d_phase_buffer.pop();
+            unsigned char *out = (unsigned char *) output_items[0];
+            uint64_t stats_start = d_stats.begin();
+
+            uint64_t s_offset = nitems_read(0);
+            get_tags_in_range(d_tags, 0, s_offset, s_offset + ninput_items[0]);
+            std::sort(d_tags.begin(), d_tags.end(), gr::tag_t::offset_compare);
+
+            int i = 0;
+            int o = flush_carry(out, noutput_items);
+            size_t tags_idx = 0;
+            d_traced.clear();
+            while (i < ninput_items[0] && o < noutput_items) {
+                for (; tags_idx < d_tags.size() && d_tags[tags_idx].offset == s_offset + i; ++tags_idx) {
+                    const gr::tag_t &tag = d_tags[tags_idx];
+                    if (pmt::eq(tag.key, d_mod_key)) {
+                        d_mapper.set_modulation((Modulation) pmt::to_long(tag.value));
+                    } else if (pmt::eq(tag.key, d_time_key)) {
+                        // Moves to the first chip of its byte, output below
+                        add_item_tag(0, nitems_written(0) + o, tag.key, tag.value, tag.srcid);
+                        d_traced.push_back({nitems_written(0) + o, pmt::to_uint64(tag.value)});
+                    } else if (pmt::eq(tag.key, d_gap_key)) {
+                        // Moves to the first zero chip, counted in chips
+                        d_gap_remaining = pmt::to_long(tag.value);
+                        int chips = d_gap_remaining * d_mapper.chips_per_byte();
+                        add_item_tag(0, nitems_written(0) + o, tag.key, pmt::from_long(chips), tag.srcid);
+                    }
                 }
-                if (o == noutput_items) break;
 
-                if (i == ninput_items[0]) break;
-                else if (i == mod_offset) {
-                    d_symbol = 0;
-                    d_curr_mod = (Modulation) pmt::to_long(tags[tags_idx++].value);
+                // The bytes up to the next tag that fit whole in the output
+                // go through one kernel call for their modulation
+                int run_end = ninput_items[0];
+                if (tags_idx < d_tags.size())
+                    run_end = std::min<uint64_t>(run_end, d_tags[tags_idx].offset - s_offset);
+                if (d_gap_remaining)
+                    run_end = std::min(run_end, i + d_gap_remaining);
+                int n = std::min(run_end - i,
+                                 (noutput_items - o) / items_per_byte(d_mapper.modulation()));
+
+                if (n > 0) {
+                    o += map_run(in + i, n, out + o * d_item_size);
+                    i += n;
+                } else {
+                    d_carry_len = map_run(in + i++, 1, d_carry);
+                    o += flush_carry(out + o * d_item_size, noutput_items - o);
                 }
-                process_byte(in[i++]);
             }
+
+            d_pending_mods.clear();
+            for (; tags_idx < d_tags.size(); ++tags_idx) {
+                if (pmt::eq(d_tags[tags_idx].key, d_mod_key))
+                    d_pending_mods.push_back({d_tags[tags_idx].offset,
+                                              (Modulation) pmt::to_long(d_tags[tags_idx].value)});
+            }
+
+            if (!d_traced.empty())
+                report_latency();
+
             consume_each(i);
+            if (d_stats.end(stats_start, i, o, d_carry_len - d_carry_pos))
+                message_port_pub(pmt::mp("stats"), d_stats.to_pmt());
             return o;
         }
 
-        
-        const std::vector<q_phase> code_mapper_impl::PHASES {
-            q_phase{0}, q_phase{1}, q_phase{2}, q_phase{3}
-        };
-
-        const std::vector<int> code_mapper_impl::BARKER {
-            1, -1, 1, 1, -1, 1, 1, 1, -1, -1, -1
-        };
-        
     } /* namespace ieee802_11_b */
 } /* namespace gr */
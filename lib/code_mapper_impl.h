@@ -24,17 +24,12 @@
 #include "common.h"
 #include <ieee802_11_b/code_mapper.h>
 
-#include <queue>
+#include "chip_mapper.h"
+#include "latency_tracker.h"
+#include "work_stats.h"
 
-struct q_phase {
-    int ph;
-
-    gr_complex to_complex() const;
-
-    q_phase neg() const;
-    q_phase operator + (const q_phase& o) const;
-    q_phase operator - () const;
-};
+#include <utility>
+#include <vector>
 
 namespace gr {
     namespace ieee802_11_b {
@@ -42,7 +37,7 @@ namespace gr {
         class code_mapper_impl : public code_mapper
         {
         public:
-            code_mapper_impl();
+            code_mapper_impl(ChipFormat format, float amplitude);
             ~code_mapper_impl();
 
             // Where all the action really happens
@@ -53,33 +48,60 @@ namespace gr {
                              gr_vector_const_void_star &input_items,
                              gr_vector_void_star &output_items);
 
-        private:
-            static const std::vector<q_phase> PHASES;
-            static const std::vector<int> BARKER;
-
-            Modulation d_curr_mod;
-            int d_symbol;
-            q_phase d_curr_phase;
-            std::queue<q_phase> d_phase_buffer;
-
-            q_phase dbpsk_symbol_to_phase (unsigned char symbol);
+            void set_stats_enabled(bool enabled) { d_stats.set_enabled(enabled); }
+            bool stats_enabled() const { return d_stats.enabled(); }
+            pmt::pmt_t stats() const { return d_stats.to_pmt(); }
+            void reset_stats() { d_stats.reset(); }
+            void set_stats_interval(double seconds) { d_stats.set_interval(seconds); }
 
-            q_phase dqpsk_symbol_to_phase (unsigned char symbol,
-                                           bool grey_coded);
+            pmt::pmt_t latency_summary() const { return d_latency.summary(); }
+            void reset_latency() { d_latency.reset(); }
 
-            void barker_spread();
-
-            void cck_spread(q_phase p2, q_phase p3, q_phase p4);
-            
-            void dbpsk_1_process_byte (unsigned char byte);
-
-            void dqpsk_2_process_byte (unsigned char byte);
-
-            void cck_5_5_process_byte (unsigned char byte);
-
-            void cck_11_process_byte (unsigned char byte);
-        
-            void process_byte (unsigned char in);};
+        private:
+            chip_mapper d_mapper;
+            ChipFormat d_format;
+            size_t d_item_size;
+            int d_chips_per_item;
+
+            // Chip LUTs in the output format, per Modulation
+            std::vector<gr_complex> d_tables_fc32[4];
+            std::vector<sc16_t> d_tables_sc16[4];
+            std::vector<sc8_t> d_tables_sc8[4];
+
+            // Chips of the last byte that did not fit in the output buffer
+            unsigned char d_carry[MAX_CHIPS_PER_BYTE * sizeof(gr_complex)];
+            int d_carry_len;
+            int d_carry_pos;
+
+            std::vector<gr::tag_t> d_tags;
+            // mod_change tags seen in the input but not yet reached
+            std::vector< std::pair<uint64_t, Modulation> > d_pending_mods;
+            const pmt::pmt_t d_mod_key;
+            const pmt::pmt_t d_time_key;
+            const pmt::pmt_t d_gap_key;
+            // Bytes of the idle gap still to be output
+            int d_gap_remaining;
+
+            work_stats d_stats;
+
+            // Output offset and arrival time of the traced PPDUs that
+            // start in the current call
+            std::vector< std::pair<uint64_t, uint64_t> > d_traced;
+            latency_tracker d_latency;
+            const pmt::pmt_t d_latency_port;
+
+            void report_latency();
+
+            int items_per_byte (Modulation m) const {
+                return chip_mapper::CHIPS_PER_BYTE[m] / d_chips_per_item;
+            }
+
+            // Writes n bytes of the current modulation in the output
+            // format, or zeros while in a gap; returns the items written
+            int map_run (const unsigned char *in, int n, unsigned char *out);
+
+            int flush_carry (unsigned char *out, int noutput_items);
+        };
 
     } // namespace ieee802_11_b
 } // namespace gr
@@ -0,0 +1,66 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2019 gr-ieee802_11_b author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "frame_coder.h"
+
+#include <cstring>
+
+namespace gr {
+    namespace ieee802_11_b {
+
+        void frame_coder::init_frame(tx_frame &frame, Modulation m,
+                                     const unsigned char *psdu, int psdu_len) const {
+            frame.modulation = m;
+            frame.psdu.assign(psdu, psdu + psdu_len);
+            frame.n_chips = prefix_cache.n_chips() + psdu_len * chip_mapper::CHIPS_PER_BYTE[m];
+        }
+
+        void frame_coder::scramble_psdu(tx_frame &frame) {
+            unsigned char header[PPDU_HEADER_LEN];
+            scr.set_state(prefix_cache.preamble_scrambler_state());
+            scr.process(header_cache.lookup(frame.modulation, frame.psdu.size()), header,
+                        PPDU_HEADER_LEN);
+            // Scrambled in place while the frame is still in cache
+            scr.process(frame.psdu.data(), frame.psdu.data(), frame.psdu.size());
+        }
+
+        q_phase frame_coder::encode(const tx_frame &frame, q_phase start, gr_complex *out) {
+            const ppdu_prefix_cache::segment &preamble = prefix_cache.preamble(start);
+            const ppdu_prefix_cache::segment &header =
+                prefix_cache.header(frame.modulation, frame.psdu.size(), preamble.end_phase);
+
+            std::memcpy(out, preamble.chips.data(), preamble.chips.size() * sizeof(gr_complex));
+            out += preamble.chips.size();
+            std::memcpy(out, header.chips.data(), header.chips.size() * sizeof(gr_complex));
+            out += header.chips.size();
+
+            chip_mapper mapper;
+            mapper.set_phase(header.end_phase);
+            mapper.set_modulation(frame.modulation);
+            mapper.map(frame.psdu.data(), frame.psdu.size(), out);
+            return mapper.phase();
+        }
+
+    } /* namespace ieee802_11_b */
+} /* namespace gr */
@@ -0,0 +1,68 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2019 gr-ieee802_11_b author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_IEEE802_11_B_FRAME_CODER_H
+#define INCLUDED_IEEE802_11_B_FRAME_CODER_H
+
+#include "chip_mapper.h"
+#include "plcp.h"
+#include "ppdu_prefix_cache.h"
+#include "scrambler.h"
+
+#include <vector>
+
+struct tx_frame {
+    Modulation modulation;
+    // Scrambled PSDU bytes; preamble and header come from the prefix cache
+    std::vector<unsigned char> psdu;
+    int n_chips;
+};
+
+namespace gr {
+    namespace ieee802_11_b {
+
+        /*
+         * Scrambles and spreads complete frames for one sync mode, outside
+         * of any block. Used by tx_frame_encoder and its worker threads, one
+         * per thread, and by the offline encoder in apps/.
+         */
+        struct frame_coder {
+            scrambler scr;
+            plcp_header_cache header_cache;
+            ppdu_prefix_cache prefix_cache;
+
+            frame_coder(bool short_sync) : scr(false), prefix_cache(short_sync) {}
+
+            // Fills in an unscrambled frame
+            void init_frame(tx_frame &frame, Modulation m,
+                            const unsigned char *psdu, int psdu_len) const;
+
+            // Scrambles the PSDU in place, continuing from the header
+            void scramble_psdu(tx_frame &frame);
+
+            // Writes the frame.n_chips chips of a scrambled frame that
+            // starts on phase start; returns the phase after the last chip
+            q_phase encode(const tx_frame &frame, q_phase start, gr_complex *out);
+        };
+
+    } // namespace ieee802_11_b
+} // namespace gr
+
+#endif /* INCLUDED_IEEE802_11_B_FRAME_CODER_H */
@@ -0,0 +1,98 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2019 gr-ieee802_11_b author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "latency_tracker.h"
+
+#include <algorithm>
+
+namespace gr {
+    namespace ieee802_11_b {
+
+        latency_tracker::latency_tracker()
+        {
+            d_window.reserve(WINDOW);
+            reset();
+        }
+
+        void latency_tracker::reset() {
+            gr::thread::scoped_lock lock(d_mutex);
+            d_window.clear();
+            d_next = 0;
+            d_count = 0;
+            d_min = UINT64_MAX;
+            d_max = 0;
+            d_sum = 0;
+        }
+
+        uint64_t latency_tracker::record(uint64_t ingress_ns, uint64_t now) {
+            // A stamp from the future can only be a foreign tag
+            uint64_t latency = now > ingress_ns ? now - ingress_ns : 0;
+
+            gr::thread::scoped_lock lock(d_mutex);
+            if (d_window.size() < WINDOW)
+                d_window.push_back(latency);
+            else
+                d_window[d_next] = latency;
+            d_next = (d_next + 1) % WINDOW;
+            d_count++;
+            d_min = std::min(d_min, latency);
+            d_max = std::max(d_max, latency);
+            d_sum += latency;
+            return latency;
+        }
+
+        pmt::pmt_t latency_tracker::summary() const {
+            std::vector<uint64_t> sorted;
+            uint64_t count, min, max;
+            double sum;
+            {
+                gr::thread::scoped_lock lock(d_mutex);
+                sorted = d_window;
+                count = d_count;
+                min = count ? d_min : 0;
+                max = d_max;
+                sum = d_sum;
+            }
+            std::sort(sorted.begin(), sorted.end());
+
+            auto percentile = [&sorted](double p) -> uint64_t {
+                if (sorted.empty())
+                    return 0;
+                return sorted[std::min(sorted.size() - 1, (size_t) (p * sorted.size()))];
+            };
+
+            pmt::pmt_t dict = pmt::make_dict();
+            dict = pmt::dict_add(dict, pmt::mp("count"), pmt::from_uint64(count));
+            dict = pmt::dict_add(dict, pmt::mp("mean_ns"), pmt::from_double(count ? sum / count : 0));
+            dict = pmt::dict_add(dict, pmt::mp("min_ns"), pmt::from_uint64(min));
+            dict = pmt::dict_add(dict, pmt::mp("max_ns"), pmt::from_uint64(max));
+            dict = pmt::dict_add(dict, pmt::mp("p50_ns"), pmt::from_uint64(percentile(0.5)));
+            dict = pmt::dict_add(dict, pmt::mp("p90_ns"), pmt::from_uint64(percentile(0.9)));
+            dict = pmt::dict_add(dict, pmt::mp("p99_ns"), pmt::from_uint64(percentile(0.99)));
+            dict = pmt::dict_add(dict, pmt::mp("p999_ns"), pmt::from_uint64(percentile(0.999)));
+            return dict;
+        }
+
+    } /* namespace ieee802_11_b */
+} /* namespace gr */
@@ -0,0 +1,74 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2019 gr-ieee802_11_b author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_IEEE802_11_B_LATENCY_TRACKER_H
+#define INCLUDED_IEEE802_11_B_LATENCY_TRACKER_H
+
+#include <gnuradio/thread/thread.h>
+#include <pmt/pmt.h>
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace gr {
+    namespace ieee802_11_b {
+
+        /*
+         * Per-frame latencies, measured against the monotonic clock that
+         * psdu_mapper stamps "ppdu_time" tags with. Keeps running totals
+         * and the last WINDOW latencies for percentiles.
+         */
+        class latency_tracker
+        {
+        public:
+            static const size_t WINDOW = 8192;
+
+            latency_tracker();
+
+            static uint64_t now_ns() {
+                return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()).count();
+            }
+
+            // Records a frame that arrived at ingress_ns and left at now;
+            // returns its latency
+            uint64_t record(uint64_t ingress_ns, uint64_t now);
+
+            // count, mean_ns, min_ns and max_ns over all frames, p50_ns,
+            // p90_ns, p99_ns and p999_ns over the last WINDOW
+            pmt::pmt_t summary() const;
+
+            void reset();
+
+        private:
+            mutable gr::thread::mutex d_mutex;
+            std::vector<uint64_t> d_window;
+            size_t d_next;
+            uint64_t d_count;
+            uint64_t d_min;
+            uint64_t d_max;
+            double d_sum;
+        };
+
+    } // namespace ieee802_11_b
+} // namespace gr
+
+#endif /* INCLUDED_IEEE802_11_B_LATENCY_TRACKER_H */
@@ -0,0 +1,275 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2019 gr-ieee802_11_b author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gnuradio/io_signature.h>
+#include "multi_tx_encoder_impl.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace gr {
+    namespace ieee802_11_b {
+
+        // Chips per channel spread between stage changes at most
+        static const int MAX_RUN_CHIPS = 512;
+
+        multi_tx_encoder::sptr
+        multi_tx_encoder::make(Modulation m, bool short_sync, int n_channels,
+                               bool interleaved)
+        {
+            return gnuradio::get_initial_sptr
+                (new multi_tx_encoder_impl(m, short_sync, n_channels, interleaved));
+        }
+
+        /*
+         * The private constructor
+         */
+        multi_tx_encoder_impl::multi_tx_encoder_impl(Modulation m, bool short_sync,
+                                                     int n_channels, bool interleaved)
+            : gr::block("multi_tx_encoder",
+                        gr::io_signature::make(0, 0, 0),
+                        gr::io_signature::make(interleaved ? 1 : std::max(n_channels, 1),
+                                               interleaved ? 1 : std::max(n_channels, 1),
+                                               sizeof(gr_complex))),
+            d_modulation(m),
+            d_n_channels(n_channels),
+            d_interleaved(interleaved),
+            d_tick_chips(chip_mapper::CHIPS_PER_BYTE[m]),
+            d_coder(short_sync),
+            d_scramble_lanes(scramble_lanes_kernel_select()),
+            d_pending(std::max(n_channels, 0)),
+            d_frames(std::max(n_channels, 0)),
+            d_frames_dropped(0),
+            d_stage(std::max(n_channels, 0), IDLE),
+            d_offset(std::max(n_channels, 0), 0),
+            d_scr_prev(std::max(n_channels, 0), 0),
+            d_scr_start(std::max(n_channels, 0), 0),
+            d_phase(std::max(n_channels, 0), 0),
+            d_psdu(std::max(n_channels, 0), nullptr),
+            d_psdu_len(std::max(n_channels, 0), 0),
+            d_psdu_bytes(std::max(n_channels, 0), 0),
+            d_prefix(std::max(n_channels, 0)),
+            d_max_run(std::max(MAX_RUN_CHIPS / d_tick_chips, 1)),
+            d_scrambled(std::max(n_channels, 0) * d_max_run),
+            d_run_chips(interleaved ? std::max(n_channels, 0) * d_max_run * d_tick_chips : 0)
+        {
+            if (short_sync && m == DBPSK_1)
+                throw std::runtime_error("Short Sync cannot be used with 1Mbps BPSK");
+            if (n_channels < 1)
+                throw std::runtime_error("Number of channels must be at least 1");
+
+            gr_complex points[4];
+            chip_mapper::phase_points(1.0f, points);
+            d_table = chip_mapper::chip_table(m, points);
+            d_mapper.set_modulation(m);
+
+            // Whole ticks only, so that no chips are ever held back
+            set_output_multiple(d_tick_chips * (interleaved ? n_channels : 1));
+
+            message_port_register_in(pmt::intern("psdu in"));
+            set_msg_handler(pmt::intern("psdu in"),
+                            boost::bind(&multi_tx_encoder_impl::psdu_in, this, _1));
+        }
+
+        multi_tx_encoder_impl::~multi_tx_encoder_impl()
+        {
+        }
+
+        void multi_tx_encoder_impl::psdu_in(pmt::pmt_t msg) {
+            long c = -1;
+            if (pmt::is_pair(msg)) {
+                pmt::pmt_t channel = pmt::car(msg);
+                if (pmt::is_dict(channel))
+                    channel = pmt::dict_ref(channel, pmt::mp("channel"), pmt::PMT_NIL);
+                if (pmt::is_integer(channel))
+                    c = pmt::to_long(channel);
+                msg = pmt::cdr(msg);
+            }
+            // The PLCP LENGTH field cannot describe PSDUs over MAX_PSDU_LEN
+            if (c < 0 || c >= d_n_channels || !pmt::is_blob(msg) ||
+                pmt::blob_length(msg) > MAX_PSDU_LEN) {
+                d_frames_dropped++;
+                return;
+            }
+
+            gr::thread::scoped_lock lock(d_mutex);
+            d_pending[c].push_back(msg);
+        }
+
+        void multi_tx_encoder_impl::start_frame(int c, uint64_t tag_offset) {
+            const pmt::pmt_t &blob = d_frames[c].front();
+            int psdu_len = pmt::blob_length(blob);
+            d_psdu[c] = static_cast<const unsigned char*>(pmt::blob_data(blob));
+            d_psdu_len[c] = psdu_len;
+
+            // Preamble and header are copied from the cache for the phase
+            // the previous frame ended on
+            const ppdu_prefix_cache::segment &preamble =
+                d_coder.prefix_cache.preamble(q_phase{d_phase[c]});
+            const ppdu_prefix_cache::segment &header =
+                d_coder.prefix_cache.header(d_modulation, psdu_len, preamble.end_phase);
+            std::vector<gr_complex> &prefix = d_prefix[c];
+            prefix.assign(preamble.chips.begin(), preamble.chips.end());
+            prefix.insert(prefix.end(), header.chips.begin(), header.chips.end());
+            d_phase[c] = header.end_phase.ph;
+
+            // The PSDU scrambler continues from the last header byte
+            unsigned char scrambled[PPDU_HEADER_LEN];
+            d_coder.scr.set_state(d_coder.prefix_cache.preamble_scrambler_state());
+            d_coder.scr.process(d_coder.header_cache.lookup(d_modulation, psdu_len),
+                                scrambled, PPDU_HEADER_LEN);
+            d_scr_start[c] = scrambled[PPDU_HEADER_LEN - 1];
+
+            // Preamble and header of every sync mode are a whole number of
+            // PSDU bytes long for every modulation, so ticks never straddle
+            // the end of the prefix
+            d_stage[c] = PREFIX;
+            d_offset[c] = 0;
+
+            const pmt::pmt_t len_key = pmt::mp("ppdu_len");
+            const pmt::pmt_t val = pmt::from_long(prefix.size() + psdu_len * d_tick_chips);
+            const pmt::pmt_t srcid = pmt::mp(alias());
+            add_item_tag(d_interleaved ? 0 : c, tag_offset, len_key, val, srcid);
+        }
+
+        template <Modulation M>
+        int multi_tx_encoder_impl::work_ticks(int n_ticks, gr_vector_void_star &output_items) {
+            typedef modulation_traits<M> traits;
+            const int N = d_n_channels;
+            const int T = traits::N_CHIPS * (8 / traits::SYMBOL_BITS);
+
+            int t = 0;
+            while (t < n_ticks) {
+                // The run ends where the first channel changes stage
+                int n_run = std::min(n_ticks - t, d_max_run);
+                int n_busy = 0;
+                for (int c = 0; c < N; ++c) {
+                    if (d_stage[c] == IDLE && !d_frames[c].empty()) {
+                        uint64_t offset = d_interleaved
+                            ? nitems_written(0) + (uint64_t) t * T * N + c
+                            : nitems_written(c) + (uint64_t) t * T;
+                        start_frame(c, offset);
+                    }
+                    if (d_stage[c] == PREFIX)
+                        n_run = std::min<int>(n_run, (d_prefix[c].size() - d_offset[c]) / T);
+                    else if (d_stage[c] == PSDU)
+                        n_run = std::min(n_run, d_psdu_len[c] - d_offset[c]);
+                    n_busy += d_stage[c] != IDLE;
+                }
+                // Returning 0 while idle lets the scheduler sleep until the
+                // next message arrives on "psdu in".
+                if (n_busy == 0) break;
+
+                // The PSDU bytes of every channel, scrambled in lock-step.
+                // Lanes outside their PSDU scramble a dummy byte; their
+                // state is set again when their PSDU starts.
+                for (int r = 0; r < n_run; ++r) {
+                    for (int c = 0; c < N; ++c)
+                        d_psdu_bytes[c] = d_stage[c] == PSDU ? d_psdu[c][d_offset[c] + r] : 0;
+                    d_scramble_lanes(d_scr_prev.data(), d_psdu_bytes.data(), N);
+                    for (int c = 0; c < N; ++c)
+                        d_scrambled[c * d_max_run + r] = d_scr_prev[c];
+                }
+
+                for (int c = 0; c < N; ++c) {
+                    gr_complex *out = d_interleaved
+                        ? &d_run_chips[c * n_run * T]
+                        : (gr_complex *) output_items[c] + t * T;
+
+                    switch (d_stage[c]) {
+                    case IDLE:
+                        std::fill_n(out, n_run * T, gr_complex(0, 0));
+                        break;
+
+                    case PREFIX:
+                        std::memcpy(out, &d_prefix[c][d_offset[c]], n_run * T * sizeof(gr_complex));
+                        d_offset[c] += n_run * T;
+                        if (d_offset[c] == (int) d_prefix[c].size()) {
+                            d_stage[c] = PSDU;
+                            d_offset[c] = 0;
+                            d_scr_prev[c] = d_scr_start[c];
+                        }
+                        break;
+
+                    default:
+                        d_mapper.set_phase(q_phase{d_phase[c]});
+                        d_mapper.map_run<M>(&d_scrambled[c * d_max_run], n_run, out,
+                                            d_table.data());
+                        d_phase[c] = d_mapper.phase().ph;
+                        d_offset[c] += n_run;
+                        break;
+                    }
+
+                    if (d_stage[c] == PSDU && d_offset[c] == d_psdu_len[c]) {
+                        d_stage[c] = IDLE;
+                        d_psdu[c] = nullptr;
+                        d_frames[c].pop_front();
+                    }
+                }
+
+                if (d_interleaved) {
+                    // In tiles of one tick, so that both sides stay in cache
+                    gr_complex *out = (gr_complex *) output_items[0] + (size_t) t * T * N;
+                    for (int k0 = 0; k0 < n_run * T; k0 += T)
+                        for (int c = 0; c < N; ++c) {
+                            const gr_complex *src = &d_run_chips[c * n_run * T + k0];
+                            for (int k = 0; k < T; ++k)
+                                out[(k0 + k) * N + c] = src[k];
+                        }
+                }
+                t += n_run;
+            }
+            return t * T * (d_interleaved ? N : 1);
+        }
+
+        int
+        multi_tx_encoder_impl::general_work (int noutput_items,
+                                             gr_vector_int &ninput_items,
+                                             gr_vector_const_void_star &input_items,
+                                             gr_vector_void_star &output_items)
+        {
+            {
+                gr::thread::scoped_lock lock(d_mutex);
+                for (int c = 0; c < d_n_channels; ++c) {
+                    for (pmt::pmt_t &msg : d_pending[c])
+                        d_frames[c].push_back(msg);
+                    d_pending[c].clear();
+                }
+            }
+
+            int n_ticks = noutput_items / (d_tick_chips * (d_interleaved ? d_n_channels : 1));
+            switch (d_modulation) {
+            case DBPSK_1:
+                return work_ticks<DBPSK_1>(n_ticks, output_items);
+            case DQPSK_2:
+                return work_ticks<DQPSK_2>(n_ticks, output_items);
+            case CCK_5_5:
+                return work_ticks<CCK_5_5>(n_ticks, output_items);
+            default:
+                return work_ticks<CCK_11>(n_ticks, output_items);
+            }
+        }
+
+    } /* namespace ieee802_11_b */
+} /* namespace gr */
@@ -0,0 +1,105 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2019 gr-ieee802_11_b author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_IEEE802_11_B_MULTI_TX_ENCODER_IMPL_H
+#define INCLUDED_IEEE802_11_B_MULTI_TX_ENCODER_IMPL_H
+
+#include <ieee802_11_b/multi_tx_encoder.h>
+#include "chip_mapper.h"
+#include "frame_coder.h"
+#include "scramble_kernels.h"
+
+#include <atomic>
+#include <deque>
+#include <vector>
+
+namespace gr {
+    namespace ieee802_11_b {
+
+        class multi_tx_encoder_impl : public multi_tx_encoder
+        {
+        public:
+            multi_tx_encoder_impl(Modulation m, bool short_sync, int n_channels,
+                                  bool interleaved);
+            ~multi_tx_encoder_impl();
+
+            // Where all the action really happens
+            int general_work(int noutput_items,
+                             gr_vector_int &ninput_items,
+                             gr_vector_const_void_star &input_items,
+                             gr_vector_void_star &output_items);
+
+            void psdu_in(pmt::pmt_t msg);
+
+            uint64_t frames_dropped() const { return d_frames_dropped; }
+
+        private:
+            enum {IDLE, PREFIX, PSDU};
+
+            Modulation d_modulation;
+            int d_n_channels;
+            bool d_interleaved;
+            // Chips of one PSDU byte; every channel advances this many
+            // chips per tick
+            int d_tick_chips;
+
+            frame_coder d_coder;
+            chip_mapper d_mapper;
+            std::vector<gr_complex> d_table;
+            scramble_lanes_kernel_t d_scramble_lanes;
+
+            // Received PSDUs per channel, and the ones taken over by
+            // general_work
+            gr::thread::mutex d_mutex;
+            std::vector< std::deque<pmt::pmt_t> > d_pending;
+            std::vector< std::deque<pmt::pmt_t> > d_frames;
+            std::atomic<uint64_t> d_frames_dropped;
+
+            // Channel state, one entry per channel. The scrambler state is
+            // the last scrambled byte, which is also the byte to spread.
+            std::vector<unsigned char> d_stage;
+            std::vector<int> d_offset;
+            std::vector<unsigned char> d_scr_prev;
+            std::vector<unsigned char> d_scr_start;
+            std::vector<unsigned char> d_phase;
+            std::vector<const unsigned char*> d_psdu;
+            std::vector<int> d_psdu_len;
+            std::vector<unsigned char> d_psdu_bytes;
+            // Preamble and header chips of the current frame
+            std::vector< std::vector<gr_complex> > d_prefix;
+
+            // Ticks spread at once: every channel keeps its stage for the
+            // whole run
+            int d_max_run;
+            // Scrambled PSDU bytes of the run, and with interleaved output
+            // its chips, channel by channel
+            std::vector<unsigned char> d_scrambled;
+            std::vector<gr_complex> d_run_chips;
+
+            void start_frame(int c, uint64_t tag_offset);
+
+            template <Modulation M>
+            int work_ticks(int n_ticks, gr_vector_void_star &output_items);
+        };
+
+    } // namespace ieee802_11_b
+} // namespace gr
+
+#endif /* INCLUDED_IEEE802_11_B_MULTI_TX_ENCODER_IMPL_H */
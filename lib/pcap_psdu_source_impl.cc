@@ -0,0 +1,185 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2019 gr-ieee802_11_b author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gnuradio/io_signature.h>
+#include <gnuradio/block_registry.h>
+#include "pcap_psdu_source_impl.h"
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+
+// Unhandled messages allowed to pile up at a receiver that is not a
+// psdu_mapper or tx_frame_encoder, which gives no other account of its
+// backlog
+#define MAX_QUEUED_MSGS 64
+
+namespace gr {
+    namespace ieee802_11_b {
+
+        pcap_psdu_source::sptr
+        pcap_psdu_source::make(const std::string &filename, bool strip_radiotap,
+                               double frame_rate, bool repeat)
+        {
+            return gnuradio::get_initial_sptr
+                (new pcap_psdu_source_impl(filename, strip_radiotap, frame_rate, repeat));
+        }
+
+        pcap_psdu_source_impl::pcap_psdu_source_impl(const std::string &filename,
+                                                     bool strip_radiotap,
+                                                     double frame_rate, bool repeat)
+            : gr::block("pcap_psdu_source",
+                        gr::io_signature::make(0, 0, 0),
+                        gr::io_signature::make(0, 0, 0)),
+            d_file(filename, psdu_file::FORMAT_AUTO, strip_radiotap),
+            d_frame_rate(frame_rate),
+            d_repeat(repeat),
+            d_port(pmt::mp("psdu out")),
+            d_sent_at_start(0),
+            d_frames_sent(0),
+            d_frames_skipped(0),
+            d_finished(true)
+        {
+            if (frame_rate < 0)
+                throw std::runtime_error("Frame rate must not be negative");
+
+            // Walk the file once so that malformed records are reported
+            // here rather than halfway through a run
+            const unsigned char *psdu;
+            int psdu_len;
+            while (d_file.next(psdu, psdu_len)) {}
+            d_file.rewind();
+
+            message_port_register_out(d_port);
+        }
+
+        pcap_psdu_source_impl::~pcap_psdu_source_impl()
+        {
+            if (d_thread) {
+                d_finished = true;
+                d_thread->interrupt();
+                d_thread->join();
+            }
+        }
+
+        bool pcap_psdu_source_impl::start() {
+            // Connections are fixed while the flowgraph runs
+            d_receivers.clear();
+            pmt::pmt_t subscribers = pmt::dict_ref(d_message_subscribers, d_port, pmt::PMT_NIL);
+            for (; pmt::is_pair(subscribers); subscribers = pmt::cdr(subscribers)) {
+                pmt::pmt_t target = pmt::car(subscribers);
+                receiver r;
+                r.block = global_block_registry.block_lookup(pmt::car(target));
+                r.port = pmt::cdr(target);
+                r.mapper = boost::dynamic_pointer_cast<psdu_mapper>(r.block);
+                r.encoder = boost::dynamic_pointer_cast<tx_frame_encoder>(r.block);
+                r.received_at_start = r.queued() ? r.frames_received() : 0;
+                d_receivers.push_back(r);
+            }
+            d_sent_at_start = d_frames_sent;
+
+            d_finished = false;
+            d_thread = boost::shared_ptr<gr::thread::thread>
+                (new gr::thread::thread(boost::bind(&pcap_psdu_source_impl::run, this)));
+            return block::start();
+        }
+
+        bool pcap_psdu_source_impl::stop() {
+            if (d_thread) {
+                d_finished = true;
+                d_thread->interrupt();
+                d_thread->join();
+                d_thread.reset();
+            }
+            d_receivers.clear();
+            return block::stop();
+        }
+
+        bool pcap_psdu_source_impl::wait_for_receivers() {
+            for (;;) {
+                if (d_finished)
+                    return false;
+
+                bool ready = true;
+                int64_t sent = d_frames_sent - d_sent_at_start;
+                for (const receiver &r : d_receivers) {
+                    if (r.queued()) {
+                        // Read the count before the space: a frame counted
+                        // as handled has already taken its slot
+                        int64_t handled = r.frames_received() - r.received_at_start;
+                        ready &= sent - handled < r.queue_space();
+                    } else {
+                        ready &= r.block->nmsgs(r.port) < MAX_QUEUED_MSGS;
+                    }
+                }
+                if (ready)
+                    return true;
+                boost::this_thread::sleep(boost::posix_time::microseconds(50));
+            }
+        }
+
+        void pcap_psdu_source_impl::run() {
+            const boost::posix_time::time_duration period =
+                boost::posix_time::microseconds(d_frame_rate > 0 ?
+                                                std::llround(1e6 / d_frame_rate) : 0);
+            boost::system_time deadline = boost::get_system_time();
+
+            try {
+                const unsigned char *psdu;
+                int psdu_len;
+                bool pass_empty = true;
+                while (!d_finished) {
+                    if (!d_file.next(psdu, psdu_len)) {
+                        d_frames_skipped += d_file.skipped();
+                        if (!d_repeat || pass_empty)
+                            return;
+                        d_file.rewind();
+                        pass_empty = true;
+                        continue;
+                    }
+                    pass_empty = false;
+
+                    if (d_frame_rate > 0) {
+                        // Do not make up for time spent waiting on receivers
+                        boost::system_time now = boost::get_system_time();
+                        if (now > deadline + period)
+                            deadline = now;
+                        boost::this_thread::sleep(deadline);
+                        deadline += period;
+                    }
+
+                    if (!wait_for_receivers())
+                        return;
+
+                    message_port_pub(d_port, pmt::cons(pmt::PMT_NIL,
+                                                       pmt::make_blob(psdu, psdu_len)));
+                    d_frames_sent++;
+                }
+            } catch (boost::thread_interrupted &) {
+            }
+        }
+
+    } /* namespace ieee802_11_b */
+} /* namespace gr */
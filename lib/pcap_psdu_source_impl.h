@@ -0,0 +1,91 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2019 gr-ieee802_11_b author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_IEEE802_11_B_PCAP_PSDU_SOURCE_IMPL_H
+#define INCLUDED_IEEE802_11_B_PCAP_PSDU_SOURCE_IMPL_H
+
+#include <atomic>
+#include <vector>
+
+#include <ieee802_11_b/pcap_psdu_source.h>
+#include <ieee802_11_b/psdu_mapper.h>
+#include <ieee802_11_b/tx_frame_encoder.h>
+#include "psdu_file.h"
+
+namespace gr {
+    namespace ieee802_11_b {
+
+        class pcap_psdu_source_impl : public pcap_psdu_source
+        {
+        public:
+            pcap_psdu_source_impl(const std::string &filename, bool strip_radiotap,
+                                  double frame_rate, bool repeat);
+            ~pcap_psdu_source_impl();
+
+            bool start();
+            bool stop();
+
+            uint64_t frames_sent() const { return d_frames_sent; }
+            uint64_t frames_skipped() const { return d_frames_skipped; }
+
+        private:
+            // A block subscribed to "psdu out"; for a psdu_mapper or
+            // tx_frame_encoder the counters tell how many posted frames it
+            // has not handled yet.
+            struct receiver {
+                basic_block_sptr block;
+                pmt::pmt_t port;
+                psdu_mapper::sptr mapper;
+                tx_frame_encoder::sptr encoder;
+                uint64_t received_at_start;
+
+                bool queued() const { return mapper || encoder; }
+                uint64_t frames_received() const {
+                    return mapper ? mapper->frames_received() : encoder->frames_received();
+                }
+                int queue_space() const {
+                    return mapper ? mapper->queue_space() : encoder->queue_space();
+                }
+            };
+
+            psdu_file d_file;
+            double d_frame_rate;
+            bool d_repeat;
+            const pmt::pmt_t d_port;
+
+            std::vector<receiver> d_receivers;
+            uint64_t d_sent_at_start;
+            std::atomic<uint64_t> d_frames_sent;
+            std::atomic<uint64_t> d_frames_skipped;
+
+            std::atomic<bool> d_finished;
+            boost::shared_ptr<gr::thread::thread> d_thread;
+
+            void run();
+
+            // Waits until every receiver can take another frame; false
+            // once the block is stopped
+            bool wait_for_receivers();
+        };
+
+    } // namespace ieee802_11_b
+} // namespace gr
+
+#endif /* INCLUDED_IEEE802_11_B_PCAP_PSDU_SOURCE_IMPL_H */
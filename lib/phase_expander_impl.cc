@@ -0,0 +1,122 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2019 gr-ieee802_11_b author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gnuradio/io_signature.h>
+#include "phase_expander_impl.h"
+#include "chip_mapper.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#define CHIPS_PER_PACKED_BYTE 4
+
+template <typename T>
+static void fill_table(float amplitude, unsigned char *table) {
+    T points[4];
+    gr::ieee802_11_b::chip_mapper::phase_points(amplitude, points);
+
+    T *out = (T *) table;
+    for (int b = 0; b < 256; ++b) {
+        for (int c = 0; c < CHIPS_PER_PACKED_BYTE; ++c)
+            *out++ = points[(b >> (2 * c)) & 0x03];
+    }
+}
+
+namespace gr {
+    namespace ieee802_11_b {
+
+        phase_expander::sptr
+        phase_expander::make(ChipFormat format, float amplitude)
+        {
+            return gnuradio::get_initial_sptr
+                (new phase_expander_impl(format, amplitude));
+        }
+
+        phase_expander_impl::phase_expander_impl(ChipFormat format, float amplitude)
+            : gr::sync_interpolator("phase_expander",
+                                    gr::io_signature::make(1, 1, sizeof(unsigned char)),
+                                    gr::io_signature::make(1, 1, chip_mapper::chip_item_size(format)),
+                                    CHIPS_PER_PACKED_BYTE),
+            d_item_size(chip_mapper::chip_item_size(format)),
+            d_table(256 * CHIPS_PER_PACKED_BYTE * d_item_size),
+            d_gap_key(pmt::mp("gap")),
+            d_gap_remaining(0)
+        {
+            if (format != CHIPS_FC32 && (amplitude < 0 || amplitude > 1))
+                throw std::runtime_error("Fixed-point amplitude must be within [0, 1]");
+
+            switch(format) {
+            case CHIPS_FC32:
+                fill_table<gr_complex>(amplitude, d_table.data());
+                break;
+            case CHIPS_SC16:
+                fill_table<sc16_t>(amplitude, d_table.data());
+                break;
+            case CHIPS_SC8:
+                fill_table<sc8_t>(amplitude, d_table.data());
+                break;
+            default:
+                throw std::runtime_error("phase_expander cannot output packed phases");
+            }
+        }
+
+        phase_expander_impl::~phase_expander_impl()
+        {
+        }
+
+        int
+        phase_expander_impl::work(int noutput_items,
+                                  gr_vector_const_void_star &input_items,
+                                  gr_vector_void_star &output_items)
+        {
+            const unsigned char *in = (const unsigned char *) input_items[0];
+            unsigned char *out = (unsigned char *) output_items[0];
+
+            const size_t block_size = CHIPS_PER_PACKED_BYTE * d_item_size;
+            const int n_bytes = noutput_items / CHIPS_PER_PACKED_BYTE;
+
+            uint64_t s_offset = nitems_read(0);
+            get_tags_in_range(d_tags, 0, s_offset, s_offset + n_bytes, d_gap_key);
+            std::sort(d_tags.begin(), d_tags.end(), gr::tag_t::offset_compare);
+
+            size_t tags_idx = 0;
+            for (int i = 0; i < n_bytes; ++i) {
+                // code_mapper writes the gap as phase 0 chips
+                while (tags_idx < d_tags.size() && d_tags[tags_idx].offset == s_offset + i)
+                    d_gap_remaining = pmt::to_long(d_tags[tags_idx++].value);
+                if (d_gap_remaining > 0) {
+                    std::memset(out, 0, block_size);
+                    d_gap_remaining -= CHIPS_PER_PACKED_BYTE;
+                } else {
+                    std::memcpy(out, &d_table[in[i] * block_size], block_size);
+                }
+                out += block_size;
+            }
+
+            return noutput_items;
+        }
+
+    } /* namespace ieee802_11_b */
+} /* namespace gr */
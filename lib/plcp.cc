@@ -0,0 +1,226 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2019 gr-ieee802_11_b author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "plcp.h"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+    // CCITT CRC-16 (x^16 + x^12 + x^5 + 1), register shifted MSB first
+    const uint16_t CRC_POLY = 0x1021;
+
+    struct crc_tables {
+        // Register update for the 8 bits leaving its top byte
+        uint16_t step[256];
+        // Bit reversal; the protected fields go out LSB first
+        uint8_t reverse[256];
+
+        crc_tables() {
+            for (int i = 0; i < 256; ++i) {
+                uint16_t state = i << 8;
+                for (int b = 0; b < 8; ++b)
+                    state = (state & 0x8000) ? (state << 1) ^ CRC_POLY : state << 1;
+                step[i] = state;
+
+                uint8_t r = 0;
+                for (int b = 0; b < 8; ++b)
+                    r |= ((i >> b) & 0x01) << (7 - b);
+                reverse[i] = r;
+            }
+        }
+    };
+
+    const crc_tables CRC_TABLES;
+
+    uint32_t protected_fields(const plcp_header &header) {
+        return header.signal
+            | ((uint32_t) header.service) << 8
+            | ((uint32_t) header.length) << 16;
+    }
+}
+
+void plcp_header::calc_crc() {
+    uint32_t prot_fields = protected_fields(*this);
+
+    uint16_t state = 0xFFFF;
+    for (int i = 0; i < 4; ++i) {
+        uint8_t byte = CRC_TABLES.reverse[prot_fields & 0xFF];
+        state = (state << 8) ^ CRC_TABLES.step[(state >> 8) ^ byte];
+        prot_fields >>= 8;
+    }
+    crc = ~state;
+}
+
+void plcp_header::calc_crc_serial() {
+    uint32_t prot_fields = protected_fields(*this);
+
+    uint16_t state = 0xFFFF;
+    for(int i = 0; i < 32; ++i) {
+        uint16_t feedback = (!!(state & 0x8000)) ^ (prot_fields & 0x01);
+        prot_fields >>= 1;
+        state <<= 1;
+        if (feedback)
+            state ^= CRC_POLY;
+    }
+    crc = ~state;
+}
+
+plcp_header_cache::plcp_header_cache() {
+    for (int i = 0; i < N_ENTRIES; ++i)
+        d_entries[i].key = -1;
+}
+
+const unsigned char *plcp_header_cache::lookup(Modulation m, unsigned int psdu_len) {
+    int64_t key = ((int64_t) psdu_len << 2) | m;
+    entry &e = d_entries[(psdu_len ^ m) % N_ENTRIES];
+    if (e.key != key) {
+        gr::ieee802_11_b::insert_header(e.header, m, psdu_len);
+        e.key = key;
+    }
+    return e.header;
+}
+
+namespace gr {
+    namespace ieee802_11_b {
+
+        void insert_long_preamble(unsigned char* buffer) {
+            std::memset(buffer, 0xFF, 16);
+            buffer[16] = 0xA0;
+            buffer[17] = 0xF3;
+        }
+
+        void insert_short_preamble(unsigned char* buffer) {
+            std::memset(buffer, 0x00, 7);
+            buffer[7] = 0xCF;
+            buffer[8] = 0x05;
+        }
+
+        void insert_header(unsigned char* buffer, Modulation m, unsigned int psdu_len) {
+            plcp_header header;
+            header.service = 0x00;
+            int doub_rate;
+            switch(m) {
+            case DBPSK_1:
+                header.signal = 0x0A;
+                doub_rate = 2;
+                break;
+            case DQPSK_2:
+                header.signal = 0x14;
+                doub_rate = 4;
+                break;
+            case CCK_5_5:
+                header.signal = 0x37;
+                doub_rate = 11;
+                break;
+            case CCK_11:
+                header.signal = 0x6E;
+                doub_rate = 22;
+                break;
+            default:
+                throw std::runtime_error("How did you get here?");
+                break;
+            }
+            int cmp = (16 * psdu_len) % doub_rate;
+            int deficit = cmp > 0 ? doub_rate - cmp : 0;
+            header.length = (16 * psdu_len + deficit) / doub_rate;
+            if (m == CCK_11 && deficit >= 16)
+                header.service |= 0x80;
+
+            header.calc_crc();
+            std::memcpy(buffer, &header, PPDU_HEADER_LEN);
+        }
+
+        bool parse_header(const unsigned char* buffer, Modulation &m, int &psdu_len) {
+            plcp_header header;
+            std::memcpy(&header, buffer, PPDU_HEADER_LEN);
+            uint16_t crc = header.crc;
+            header.calc_crc();
+            if (crc != header.crc)
+                return false;
+
+            int doub_rate;
+            switch(header.signal) {
+            case 0x0A:
+                m = DBPSK_1;
+                doub_rate = 2;
+                break;
+            case 0x14:
+                m = DQPSK_2;
+                doub_rate = 4;
+                break;
+            case 0x37:
+                m = CCK_5_5;
+                doub_rate = 11;
+                break;
+            case 0x6E:
+                m = CCK_11;
+                doub_rate = 22;
+                break;
+            default:
+                return false;
+            }
+            // length is the PSDU duration in microseconds, rounded up
+            psdu_len = (header.length * doub_rate) / 16;
+            if (m == CCK_11 && (header.service & 0x80))
+                psdu_len--;
+            return psdu_len >= 0 && psdu_len <= MAX_PSDU_LEN;
+        }
+
+        int ppdu_prefix_len(bool short_sync) {
+            return (short_sync ? SHORT_PREAMBLE_LEN : LONG_PREAMBLE_LEN) + PPDU_HEADER_LEN;
+        }
+
+        void build_ppdu_prefix(Modulation m, bool short_sync, int psdu_len,
+                               unsigned char *prefix,
+                               std::vector< std::pair<int, Modulation> > &mod_tags,
+                               plcp_header_cache *cache) {
+            int preamble_len = short_sync ? SHORT_PREAMBLE_LEN : LONG_PREAMBLE_LEN;
+            int prefix_len = preamble_len + PPDU_HEADER_LEN;
+
+            mod_tags.push_back({0, DBPSK_1});
+            if (short_sync) {
+                insert_short_preamble(prefix);
+                mod_tags.push_back({preamble_len, DQPSK_2});
+            } else {
+                insert_long_preamble(prefix);
+            }
+            if (cache)
+                std::memcpy(prefix + preamble_len, cache->lookup(m, psdu_len), PPDU_HEADER_LEN);
+            else
+                insert_header(prefix + preamble_len, m, psdu_len);
+            mod_tags.push_back({prefix_len, m});
+        }
+
+        void build_ppdu(Modulation m, bool short_sync,
+                        const unsigned char *psdu, int psdu_len,
+                        unsigned char *ppdu,
+                        std::vector< std::pair<int, Modulation> > &mod_tags,
+                        plcp_header_cache *cache) {
+            build_ppdu_prefix(m, short_sync, psdu_len, ppdu, mod_tags, cache);
+            std::memcpy(ppdu + ppdu_prefix_len(short_sync), psdu, psdu_len);
+        }
+
+    } /* namespace ieee802_11_b */
+} /* namespace gr */
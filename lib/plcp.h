@@ -0,0 +1,109 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2019 gr-ieee802_11_b author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_IEEE802_11_B_PLCP_H
+#define INCLUDED_IEEE802_11_B_PLCP_H
+
+#include "common.h"
+
+#include <utility>
+#include <vector>
+
+#define PPDU_HEADER_LEN 6
+#define LONG_PREAMBLE_LEN 18
+#define SHORT_PREAMBLE_LEN 9
+#define MAX_PSDU_LEN 4095
+
+struct plcp_header {
+    uint8_t signal;
+    uint8_t service;
+    uint16_t length;
+    uint16_t crc;
+
+    // Table-driven CRC-16 over signal, service and length
+    void calc_crc();
+    // Bit-serial reference, one register step per protected bit
+    void calc_crc_serial();
+}__attribute__((packed));
+
+/*
+ * Small direct-mapped cache of complete PLCP headers keyed by
+ * (modulation, PSDU length). Traffic tends to repeat a handful of frame
+ * sizes, so a hit turns header generation into one 6-byte lookup. Not
+ * thread-safe; each block owns its own.
+ */
+class plcp_header_cache {
+public:
+    plcp_header_cache();
+
+    // Returns the PPDU_HEADER_LEN header bytes for a PSDU of psdu_len bytes
+    const unsigned char *lookup(Modulation m, unsigned int psdu_len);
+
+private:
+    static const int N_ENTRIES = 64;
+
+    struct entry {
+        int64_t key;
+        unsigned char header[PPDU_HEADER_LEN];
+    };
+    entry d_entries[N_ENTRIES];
+};
+
+namespace gr {
+    namespace ieee802_11_b {
+
+        void insert_long_preamble(unsigned char* buffer);
+
+        void insert_short_preamble(unsigned char* buffer);
+
+        void insert_header(unsigned char* buffer, Modulation m, unsigned int psdu_len);
+
+        /*
+         * Inverse of insert_header. Returns false if the CRC, the signal
+         * field or the PSDU length is invalid.
+         */
+        bool parse_header(const unsigned char* buffer, Modulation &m, int &psdu_len);
+
+        int ppdu_prefix_len(bool short_sync);
+
+        /*
+         * Writes preamble and PLCP header for a PSDU of psdu_len bytes to
+         * `prefix`, which must hold ppdu_prefix_len(short_sync) bytes, and
+         * appends the modulation of each segment (relative byte offset)
+         * to mod_tags. The header is taken from `cache` when one is given.
+         */
+        void build_ppdu_prefix(Modulation m, bool short_sync, int psdu_len,
+                               unsigned char *prefix,
+                               std::vector< std::pair<int, Modulation> > &mod_tags,
+                               plcp_header_cache *cache = nullptr);
+
+        /*
+         * As build_ppdu_prefix, followed by the PSDU itself. `ppdu` must
+         * hold ppdu_prefix_len(short_sync) + psdu_len bytes.
+         */
+        void build_ppdu(Modulation m, bool short_sync,
+                        const unsigned char *psdu, int psdu_len,
+                        unsigned char *ppdu,
+                        std::vector< std::pair<int, Modulation> > &mod_tags,
+                        plcp_header_cache *cache = nullptr);
+
+    } // namespace ieee802_11_b
+} // namespace gr
+
+#endif /* INCLUDED_IEEE802_11_B_PLCP_H */
@@ -0,0 +1,183 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2019 gr-ieee802_11_b author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gnuradio/io_signature.h>
+#include "plcp_sync_impl.h"
+
+#include <cstring>
+
+// Last four preamble bytes as a word in stream order: the end of the
+// sync field followed by the 16 bit SFD
+static uint32_t sfd_word(void (*insert_preamble)(unsigned char*), int preamble_len) {
+    unsigned char preamble[LONG_PREAMBLE_LEN];
+    insert_preamble(preamble);
+    const unsigned char *p = preamble + preamble_len - 4;
+    return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t) p[3] << 24;
+}
+
+static const uint32_t LONG_SFD = sfd_word(gr::ieee802_11_b::insert_long_preamble, LONG_PREAMBLE_LEN);
+static const uint32_t SHORT_SFD = sfd_word(gr::ieee802_11_b::insert_short_preamble, SHORT_PREAMBLE_LEN);
+
+namespace gr {
+    namespace ieee802_11_b {
+
+        plcp_sync::sptr
+        plcp_sync::make()
+        {
+            return gnuradio::get_initial_sptr
+                (new plcp_sync_impl());
+        }
+
+        plcp_sync_impl::plcp_sync_impl()
+            : gr::block("plcp_sync",
+                        gr::io_signature::make(1, 1, sizeof(unsigned char)),
+                        gr::io_signature::make(1, 1, sizeof(unsigned char))),
+            d_state(SEARCH),
+            d_window(0),
+            d_shift(0),
+            d_carry(0),
+            d_short_sync(false),
+            d_modulation(DBPSK_1),
+            d_header_len(0),
+            d_psdu_len(0),
+            d_frames_received(0),
+            d_header_errors(0)
+        {
+            d_psdu.reserve(MAX_PSDU_LEN);
+
+            message_port_register_out(pmt::mp("psdu out"));
+            // A header is only written once its CRC has been checked
+            set_min_noutput_items(PPDU_HEADER_LEN);
+            set_tag_propagation_policy(block::TPP_DONT);
+        }
+
+        plcp_sync_impl::~plcp_sync_impl()
+        {
+        }
+
+        void
+        plcp_sync_impl::forecast (int noutput_items, gr_vector_int &ninput_items_required)
+        {
+            ninput_items_required[0] = noutput_items;
+        }
+
+        bool plcp_sync_impl::find_sfd(unsigned char byte) {
+            // Compare the SFD words ending at each of the 8 new bit
+            // positions, earliest first
+            for (int s = 7; s >= 0; --s) {
+                uint32_t word = d_window >> (32 - s);
+                if (word != LONG_SFD && word != SHORT_SFD) continue;
+
+                d_short_sync = word == SHORT_SFD;
+                // The last s bits of this byte already belong to the header
+                d_shift = s;
+                d_carry = s ? byte >> (8 - s) : 0;
+                return true;
+            }
+            return false;
+        }
+
+        unsigned char plcp_sync_impl::realign(unsigned char byte) {
+            if (!d_shift) return byte;
+            unsigned char aligned = d_carry | (byte << d_shift);
+            d_carry = byte >> (8 - d_shift);
+            return aligned;
+        }
+
+        void plcp_sync_impl::publish_psdu() {
+            pmt::pmt_t meta = pmt::make_dict();
+            meta = pmt::dict_add(meta, pmt::mp("modulation"), pmt::from_long(d_modulation));
+            meta = pmt::dict_add(meta, pmt::mp("psdu_len"), pmt::from_long(d_psdu_len));
+            meta = pmt::dict_add(meta, pmt::mp("short_sync"), pmt::from_bool(d_short_sync));
+
+            pmt::pmt_t blob = pmt::make_blob(d_psdu.data(), d_psdu.size());
+            message_port_pub(pmt::mp("psdu out"), pmt::cons(meta, blob));
+            d_frames_received++;
+        }
+
+        int
+        plcp_sync_impl::general_work (int noutput_items,
+                                      gr_vector_int &ninput_items,
+                                      gr_vector_const_void_star &input_items,
+                                      gr_vector_void_star &output_items)
+        {
+            const unsigned char *in = (const unsigned char *) input_items[0];
+            unsigned char *out = (unsigned char *) output_items[0];
+
+            const pmt::pmt_t mod_key = pmt::mp("mod_change");
+            const pmt::pmt_t srcid = pmt::mp(alias());
+
+            int i = 0, o = 0;
+            while (i < ninput_items[0]) {
+                if (d_state == HEADER && d_header_len == PPDU_HEADER_LEN - 1 &&
+                    noutput_items - o < PPDU_HEADER_LEN) break;
+                if (d_state == PSDU && o == noutput_items) break;
+
+                unsigned char byte = in[i++];
+                d_window = (d_window >> 8) | ((uint64_t) byte << 56);
+
+                if (d_state == SEARCH) {
+                    if (find_sfd(byte)) {
+                        d_state = HEADER;
+                        d_header_len = 0;
+                    }
+                    continue;
+                }
+
+                unsigned char aligned = realign(byte);
+                if (d_state == PSDU) {
+                    out[o++] = aligned;
+                    d_psdu.push_back(aligned);
+                } else {
+                    d_header[d_header_len++] = aligned;
+                    if (d_header_len < PPDU_HEADER_LEN) continue;
+
+                    if (!parse_header(d_header, d_modulation, d_psdu_len)) {
+                        d_header_errors++;
+                        d_state = SEARCH;
+                        continue;
+                    }
+
+                    add_item_tag(0, nitems_written(0) + o, mod_key,
+                                 pmt::from_long(d_short_sync ? DQPSK_2 : DBPSK_1), srcid);
+                    std::memcpy(out + o, d_header, PPDU_HEADER_LEN);
+                    o += PPDU_HEADER_LEN;
+                    add_item_tag(0, nitems_written(0) + o, mod_key,
+                                 pmt::from_long(d_modulation), srcid);
+                    d_psdu.clear();
+                    d_state = PSDU;
+                }
+
+                if ((int) d_psdu.size() == d_psdu_len) {
+                    publish_psdu();
+                    d_state = SEARCH;
+                }
+            }
+
+            consume_each(i);
+            return o;
+        }
+
+    } /* namespace ieee802_11_b */
+} /* namespace gr */
@@ -0,0 +1,79 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2019 gr-ieee802_11_b author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_IEEE802_11_B_PLCP_SYNC_IMPL_H
+#define INCLUDED_IEEE802_11_B_PLCP_SYNC_IMPL_H
+
+#include <ieee802_11_b/plcp_sync.h>
+#include "plcp.h"
+
+#include <vector>
+
+namespace gr {
+    namespace ieee802_11_b {
+
+        class plcp_sync_impl : public plcp_sync
+        {
+        public:
+            plcp_sync_impl();
+            ~plcp_sync_impl();
+
+            // Where all the action really happens
+            void forecast (int noutput_items, gr_vector_int &ninput_items_required);
+
+            int general_work(int noutput_items,
+                             gr_vector_int &ninput_items,
+                             gr_vector_const_void_star &input_items,
+                             gr_vector_void_star &output_items);
+
+            uint64_t frames_received() const { return d_frames_received; }
+            uint64_t header_errors() const { return d_header_errors; }
+
+        private:
+            enum sync_state { SEARCH, HEADER, PSDU };
+
+            sync_state d_state;
+            // Last 64 input bits, oldest in bit 0
+            uint64_t d_window;
+
+            // Frame bits are realigned by combining the d_shift bits left
+            // over from the previous input byte with the next one
+            int d_shift;
+            unsigned char d_carry;
+
+            bool d_short_sync;
+            Modulation d_modulation;
+            unsigned char d_header[PPDU_HEADER_LEN];
+            int d_header_len;
+            std::vector<unsigned char> d_psdu;
+            int d_psdu_len;
+
+            uint64_t d_frames_received;
+            uint64_t d_header_errors;
+
+            bool find_sfd(unsigned char byte);
+            unsigned char realign(unsigned char byte);
+            void publish_psdu();
+        };
+
+    } // namespace ieee802_11_b
+} // namespace gr
+
+#endif /* INCLUDED_IEEE802_11_B_PLCP_SYNC_IMPL_H */
@@ -0,0 +1,88 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2019 gr-ieee802_11_b author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "ppdu_prefix_cache.h"
+
+#include <cstring>
+
+namespace gr {
+    namespace ieee802_11_b {
+
+        ppdu_prefix_cache::ppdu_prefix_cache(bool short_sync)
+            : d_header_mod(short_sync ? DQPSK_2 : DBPSK_1),
+              d_scrambler(false)
+        {
+            int preamble_len = short_sync ? SHORT_PREAMBLE_LEN : LONG_PREAMBLE_LEN;
+            unsigned char preamble[LONG_PREAMBLE_LEN];
+            if (short_sync)
+                insert_short_preamble(preamble);
+            else
+                insert_long_preamble(preamble);
+
+            d_scrambler.reset();
+            d_scrambler.process(preamble, preamble, preamble_len);
+            d_preamble_state = d_scrambler.state();
+
+            for (int ph = 0; ph < 4; ++ph)
+                map_segment(DBPSK_1, preamble, preamble_len, q_phase{ph}, d_preamble[ph]);
+
+            d_n_chips = d_preamble[0].chips.size() +
+                PPDU_HEADER_LEN * chip_mapper::CHIPS_PER_BYTE[d_header_mod];
+
+            for (int i = 0; i < N_ENTRIES; ++i)
+                d_entries[i].key = -1;
+        }
+
+        void ppdu_prefix_cache::map_segment(Modulation m, const unsigned char *bytes, int n,
+                                            q_phase start, segment &seg) {
+            chip_mapper mapper;
+            mapper.set_modulation(m);
+            mapper.set_phase(start);
+            seg.chips.resize(n * chip_mapper::CHIPS_PER_BYTE[m]);
+            mapper.map(bytes, n, seg.chips.data());
+            seg.end_phase = mapper.phase();
+        }
+
+        const ppdu_prefix_cache::segment &
+        ppdu_prefix_cache::header(Modulation m, unsigned int psdu_len, q_phase start) {
+            int64_t key = ((int64_t) psdu_len << 2) | m;
+            entry &e = d_entries[(psdu_len ^ m) % N_ENTRIES];
+            if (e.key != key) {
+                // The header is always scrambled from the same state
+                d_scrambler.set_state(d_preamble_state);
+                d_scrambler.process(d_header_bytes.lookup(m, psdu_len), e.header,
+                                    PPDU_HEADER_LEN);
+                for (segment &seg : e.by_phase)
+                    seg.chips.clear();
+                e.key = key;
+            }
+
+            segment &seg = e.by_phase[start.ph];
+            if (seg.chips.empty())
+                map_segment(d_header_mod, e.header, PPDU_HEADER_LEN, start, seg);
+            return seg;
+        }
+
+    } /* namespace ieee802_11_b */
+} /* namespace gr */
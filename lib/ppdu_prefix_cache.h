@@ -0,0 +1,87 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2019 gr-ieee802_11_b author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_IEEE802_11_B_PPDU_PREFIX_CACHE_H
+#define INCLUDED_IEEE802_11_B_PPDU_PREFIX_CACHE_H
+
+#include "chip_mapper.h"
+#include "plcp.h"
+#include "scrambler.h"
+
+#include <vector>
+
+namespace gr {
+    namespace ieee802_11_b {
+
+        /*
+         * Scrambled and spread chips of the PPDU prefix for one sync mode.
+         * The preamble chips are the same for every frame; the header chips
+         * are kept in a small direct-mapped cache keyed by (modulation, PSDU
+         * length). The chips depend on the differential phase a segment
+         * starts from, so each segment has one copy per starting phase,
+         * built on first use. Not thread-safe; each block owns its own.
+         */
+        class ppdu_prefix_cache
+        {
+        public:
+            struct segment {
+                std::vector<gr_complex> chips;
+                // Phase after the last chip, where the next segment starts
+                q_phase end_phase;
+            };
+
+            ppdu_prefix_cache(bool short_sync);
+
+            const segment &preamble(q_phase start) const { return d_preamble[start.ph]; }
+
+            const segment &header(Modulation m, unsigned int psdu_len, q_phase start);
+
+            // Scrambler state after the preamble, identical for every frame
+            int preamble_scrambler_state() const { return d_preamble_state; }
+
+            // Chips of preamble and header together
+            int n_chips() const { return d_n_chips; }
+
+        private:
+            static const int N_ENTRIES = 16;
+
+            struct entry {
+                int64_t key;
+                unsigned char header[PPDU_HEADER_LEN];
+                segment by_phase[4];
+            };
+
+            Modulation d_header_mod;
+            int d_preamble_state;
+            int d_n_chips;
+            segment d_preamble[4];
+            entry d_entries[N_ENTRIES];
+
+            plcp_header_cache d_header_bytes;
+            scrambler d_scrambler;
+
+            static void map_segment(Modulation m, const unsigned char *bytes, int n,
+                                    q_phase start, segment &seg);
+        };
+
+    } // namespace ieee802_11_b
+} // namespace gr
+
+#endif /* INCLUDED_IEEE802_11_B_PPDU_PREFIX_CACHE_H */
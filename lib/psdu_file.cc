@@ -0,0 +1,276 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2019 gr-ieee802_11_b author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "psdu_file.h"
+#include "plcp.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#define PCAP_MAGIC 0xa1b2c3d4
+#define PCAP_MAGIC_NS 0xa1b23c4d
+#define PCAP_HEADER_LEN 24
+#define PCAP_RECORD_HEADER_LEN 16
+
+#define PCAPNG_SHB 0x0A0D0D0A
+#define PCAPNG_IDB 0x00000001
+#define PCAPNG_SPB 0x00000003
+#define PCAPNG_EPB 0x00000006
+#define PCAPNG_BYTE_ORDER_MAGIC 0x1A2B3C4D
+#define PCAPNG_MIN_BLOCK_LEN 12
+
+#define LINKTYPE_IEEE802_11 105
+#define LINKTYPE_IEEE802_11_RADIOTAP 127
+
+static uint32_t bswap32(uint32_t x) {
+    return (x >> 24) | ((x >> 8) & 0xFF00) | ((x << 8) & 0xFF0000) | (x << 24);
+}
+
+namespace gr {
+    namespace ieee802_11_b {
+
+        psdu_file::psdu_file(const std::string &path, file_format format,
+                             bool strip_radiotap)
+            : d_data(nullptr),
+              d_size(0),
+              d_pos(0),
+              d_format(format),
+              d_skipped(0),
+              d_strip_radiotap(strip_radiotap),
+              d_swapped(false),
+              d_linktype(0)
+        {
+            int fd = open(path.c_str(), O_RDONLY);
+            if (fd < 0)
+                throw std::runtime_error("Cannot open " + path + ": " + std::strerror(errno));
+
+            struct stat st;
+            if (fstat(fd, &st) < 0) {
+                close(fd);
+                throw std::runtime_error("Cannot stat " + path + ": " + std::strerror(errno));
+            }
+
+            d_size = st.st_size;
+            if (d_size > 0) {
+                void *p = mmap(nullptr, d_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (p == MAP_FAILED) {
+                    close(fd);
+                    throw std::runtime_error("Cannot map " + path + ": " + std::strerror(errno));
+                }
+                d_data = static_cast<const unsigned char *>(p);
+                madvise(p, d_size, MADV_SEQUENTIAL);
+            }
+            close(fd);
+
+            uint32_t magic = d_size >= 4 ? read_u32(0) : 0;
+            bool is_pcap = magic == PCAP_MAGIC || magic == PCAP_MAGIC_NS ||
+                bswap32(magic) == PCAP_MAGIC || bswap32(magic) == PCAP_MAGIC_NS;
+            bool is_pcapng = magic == PCAPNG_SHB;
+            if (d_format == FORMAT_AUTO)
+                d_format = is_pcap ? FORMAT_PCAP : is_pcapng ? FORMAT_PCAPNG : FORMAT_RAW;
+
+            const char *error = nullptr;
+            if (d_format == FORMAT_PCAP) {
+                if (!is_pcap || d_size < PCAP_HEADER_LEN) {
+                    error = " is not a pcap file";
+                } else {
+                    d_swapped = magic != PCAP_MAGIC && magic != PCAP_MAGIC_NS;
+                    d_linktype = read_u32(20) & 0xFFFF;
+                    if (d_linktype != LINKTYPE_IEEE802_11 &&
+                        d_linktype != LINKTYPE_IEEE802_11_RADIOTAP)
+                        error = " does not hold 802.11 frames";
+                }
+            } else if (d_format == FORMAT_PCAPNG) {
+                if (!is_pcapng || d_size < PCAPNG_MIN_BLOCK_LEN)
+                    error = " is not a pcapng file";
+            }
+            if (error) {
+                munmap((void *) d_data, d_size);
+                throw std::runtime_error(path + error);
+            }
+            rewind();
+        }
+
+        psdu_file::~psdu_file()
+        {
+            if (d_data)
+                munmap((void *) d_data, d_size);
+        }
+
+        uint32_t psdu_file::read_u32(size_t offset) const {
+            uint32_t x;
+            std::memcpy(&x, d_data + offset, sizeof(x));
+            return d_swapped ? bswap32(x) : x;
+        }
+
+        uint16_t psdu_file::read_u16(size_t offset) const {
+            uint16_t x;
+            std::memcpy(&x, d_data + offset, sizeof(x));
+            return d_swapped ? (x >> 8 | x << 8) : x;
+        }
+
+        void psdu_file::rewind() {
+            d_pos = d_format == FORMAT_PCAP ? PCAP_HEADER_LEN : 0;
+            d_skipped = 0;
+            d_if_linktypes.clear();
+        }
+
+        bool psdu_file::next(const unsigned char *&psdu, int &psdu_len) {
+            switch(d_format) {
+            case FORMAT_PCAP:
+                return next_pcap(psdu, psdu_len);
+            case FORMAT_PCAPNG:
+                return next_pcapng(psdu, psdu_len);
+            default:
+                return next_raw(psdu, psdu_len);
+            }
+        }
+
+        bool psdu_file::accept(uint32_t linktype, const unsigned char *frame,
+                               uint32_t incl_len, uint32_t orig_len,
+                               const unsigned char *&psdu, int &psdu_len) {
+            if (linktype != LINKTYPE_IEEE802_11 &&
+                linktype != LINKTYPE_IEEE802_11_RADIOTAP)
+                return false;
+
+            // Radiotap headers are little-endian regardless of the file
+            uint32_t skip = 0;
+            if (linktype == LINKTYPE_IEEE802_11_RADIOTAP && d_strip_radiotap)
+                skip = incl_len >= 4 ? (frame[2] | frame[3] << 8) : incl_len + 1;
+
+            if (incl_len < orig_len || skip > incl_len ||
+                incl_len - skip > MAX_PSDU_LEN)
+                return false;
+
+            psdu = frame + skip;
+            psdu_len = incl_len - skip;
+            return true;
+        }
+
+        bool psdu_file::next_raw(const unsigned char *&psdu, int &psdu_len) {
+            if (d_pos == d_size)
+                return false;
+            if (d_size - d_pos < 2)
+                throw std::runtime_error("Truncated PSDU record");
+
+            int len = d_data[d_pos] | d_data[d_pos + 1] << 8;
+            if (len > MAX_PSDU_LEN)
+                throw std::runtime_error("PSDU record longer than MAX_PSDU_LEN");
+            if (d_size - d_pos - 2 < (size_t) len)
+                throw std::runtime_error("Truncated PSDU record");
+
+            psdu = d_data + d_pos + 2;
+            psdu_len = len;
+            d_pos += 2 + len;
+            return true;
+        }
+
+        bool psdu_file::next_pcap(const unsigned char *&psdu, int &psdu_len) {
+            for (;;) {
+                if (d_pos == d_size)
+                    return false;
+
+                // A capture cut off in the middle of a record ends the file
+                if (d_size - d_pos < PCAP_RECORD_HEADER_LEN ||
+                    d_size - d_pos - PCAP_RECORD_HEADER_LEN < read_u32(d_pos + 8)) {
+                    d_skipped++;
+                    d_pos = d_size;
+                    return false;
+                }
+
+                uint32_t incl_len = read_u32(d_pos + 8);
+                uint32_t orig_len = read_u32(d_pos + 12);
+                const unsigned char *frame = d_data + d_pos + PCAP_RECORD_HEADER_LEN;
+                d_pos += PCAP_RECORD_HEADER_LEN + incl_len;
+
+                if (accept(d_linktype, frame, incl_len, orig_len, psdu, psdu_len))
+                    return true;
+                d_skipped++;
+            }
+        }
+
+        bool psdu_file::next_pcapng(const unsigned char *&psdu, int &psdu_len) {
+            for (;;) {
+                if (d_pos == d_size)
+                    return false;
+
+                // Each section header fixes the byte order of its blocks
+                if (d_size - d_pos >= PCAPNG_MIN_BLOCK_LEN &&
+                    read_u32(d_pos) == PCAPNG_SHB) {
+                    uint32_t bom;
+                    std::memcpy(&bom, d_data + d_pos + 8, sizeof(bom));
+                    if (bom != PCAPNG_BYTE_ORDER_MAGIC &&
+                        bswap32(bom) != PCAPNG_BYTE_ORDER_MAGIC)
+                        throw std::runtime_error("Bad pcapng byte-order magic");
+                    d_swapped = bom != PCAPNG_BYTE_ORDER_MAGIC;
+                    d_if_linktypes.clear();
+                }
+
+                // A capture cut off in the middle of a block ends the file
+                uint32_t block_len = d_size - d_pos >= PCAPNG_MIN_BLOCK_LEN ?
+                    read_u32(d_pos + 4) : 0;
+                if (block_len < PCAPNG_MIN_BLOCK_LEN || block_len % 4 ||
+                    block_len > d_size - d_pos) {
+                    d_skipped++;
+                    d_pos = d_size;
+                    return false;
+                }
+
+                size_t block = d_pos;
+                uint32_t type = read_u32(block);
+                d_pos += block_len;
+
+                if (type == PCAPNG_IDB && block_len >= 20) {
+                    d_if_linktypes.push_back(read_u16(block + 8));
+                } else if (type == PCAPNG_EPB && block_len >= 32) {
+                    uint32_t iface = read_u32(block + 8);
+                    uint32_t incl_len = read_u32(block + 20);
+                    uint32_t orig_len = read_u32(block + 24);
+                    if (iface < d_if_linktypes.size() && incl_len <= block_len - 32 &&
+                        accept(d_if_linktypes[iface], d_data + block + 28,
+                               incl_len, orig_len, psdu, psdu_len))
+                        return true;
+                    d_skipped++;
+                } else if (type == PCAPNG_SPB && block_len >= 16) {
+                    // Simple packets belong to the first interface
+                    uint32_t orig_len = read_u32(block + 8);
+                    uint32_t incl_len = std::min<uint32_t>(orig_len, block_len - 16);
+                    if (!d_if_linktypes.empty() &&
+                        accept(d_if_linktypes[0], d_data + block + 12,
+                               incl_len, orig_len, psdu, psdu_len))
+                        return true;
+                    d_skipped++;
+                }
+            }
+        }
+
+    } /* namespace ieee802_11_b */
+} /* namespace gr */
@@ -0,0 +1,92 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2019 gr-ieee802_11_b author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_IEEE802_11_B_PSDU_FILE_H
+#define INCLUDED_IEEE802_11_B_PSDU_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace gr {
+    namespace ieee802_11_b {
+
+        /*
+         * Read-only memory map of a file of PSDUs, either raw records (a
+         * 16 bit little-endian length followed by that many bytes) or a
+         * pcap/pcapng capture of 802.11 frames, with or without radiotap
+         * headers. PSDUs are returned in place. Captured packets that were
+         * truncated, exceed MAX_PSDU_LEN or come from a non 802.11
+         * interface are skipped; anything else that does not parse throws
+         * std::runtime_error.
+         */
+        class psdu_file
+        {
+        public:
+            enum file_format { FORMAT_AUTO, FORMAT_RAW, FORMAT_PCAP, FORMAT_PCAPNG };
+
+            psdu_file(const std::string &path, file_format format = FORMAT_AUTO,
+                      bool strip_radiotap = true);
+            ~psdu_file();
+
+            // Points psdu at the next PSDU; false at the end of the file
+            bool next(const unsigned char *&psdu, int &psdu_len);
+
+            // Starts over at the first PSDU
+            void rewind();
+
+            file_format format() const { return d_format; }
+            uint64_t skipped() const { return d_skipped; }
+
+        private:
+            const unsigned char *d_data;
+            size_t d_size;
+            size_t d_pos;
+            file_format d_format;
+            uint64_t d_skipped;
+
+            // Captures only
+            bool d_strip_radiotap;
+            bool d_swapped;
+            uint32_t d_linktype;
+            // Link type of every pcapng interface in the current section
+            std::vector<uint32_t> d_if_linktypes;
+
+            uint32_t read_u32(size_t offset) const;
+            uint16_t read_u16(size_t offset) const;
+
+            // Applies the capture checks and radiotap stripping to a packet
+            bool accept(uint32_t linktype, const unsigned char *frame,
+                        uint32_t incl_len, uint32_t orig_len,
+                        const unsigned char *&psdu, int &psdu_len);
+
+            bool next_raw(const unsigned char *&psdu, int &psdu_len);
+            bool next_pcap(const unsigned char *&psdu, int &psdu_len);
+            bool next_pcapng(const unsigned char *&psdu, int &psdu_len);
+
+            psdu_file(const psdu_file &) = delete;
+            psdu_file &operator=(const psdu_file &) = delete;
+        };
+
+    } // namespace ieee802_11_b
+} // namespace gr
+
+#endif /* INCLUDED_IEEE802_11_B_PSDU_FILE_H */
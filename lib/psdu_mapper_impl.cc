@@ -25,57 +25,86 @@
 #include <gnuradio/io_signature.h>
 #include "psdu_mapper_impl.h"
 
-void plcp_header::calc_crc() {
-    uint32_t prot_fields = signal;
-    prot_fields |= ((uint32_t) service) << 8;
-    prot_fields |= ((uint32_t) length) << 16;
-
-    uint16_t state = 0xFFFF;
-    for(int i = 0; i < 32; ++i) {
-        uint32_t feedback = (!!(state & 0x8000)) ^ (prot_fields & 0x01);
-        state <<= 1;
-        state |= feedback | (feedback << 5) | (feedback << 12);
+void ppdu_info::copy(unsigned char *out, int offset, int n) const {
+    if (offset < prefix_len) {
+        int n_prefix = std::min(n, prefix_len - offset);
+        std::memcpy(out, prefix + offset, n_prefix);
+        out += n_prefix;
+        offset += n_prefix;
+        n -= n_prefix;
     }
-    crc = ~state;
-};
+    std::memcpy(out, psdu + (offset - prefix_len), n);
+}
 
-ppdu_info::ppdu_info(int ppdu_len)
-    : ppdu_len(ppdu_len)
+ppdu_queue::ppdu_queue(size_t depth)
+    : d_slots(depth),
+      d_head(0),
+      d_tail(0)
 {
-    ppdu = static_cast<unsigned char *>(malloc(ppdu_len * sizeof(unsigned char)));
 }
 
-ppdu_info::~ppdu_info()
-{
-    free(ppdu);
+bool ppdu_queue::empty() const {
+    return d_head.load(std::memory_order_relaxed) == d_tail.load(std::memory_order_acquire);
+}
+
+size_t ppdu_queue::space() const {
+    return depth() - (d_tail.load(std::memory_order_relaxed) - d_head.load(std::memory_order_acquire));
+}
+
+bool ppdu_queue::full() const {
+    return d_tail.load(std::memory_order_relaxed) - d_head.load(std::memory_order_acquire) == depth();
+}
+
+void ppdu_queue::pop() {
+    ppdu_info &ppdu_i = front();
+    ppdu_i.psdu_blob = pmt::PMT_NIL;
+    ppdu_i.psdu = nullptr;
+    ppdu_i.mod_tags.clear();
+    d_head.fetch_add(1, std::memory_order_release);
+}
+
+void ppdu_queue::push() {
+    d_tail.fetch_add(1, std::memory_order_release);
 }
 
 namespace gr {
     namespace ieee802_11_b {
 
         psdu_mapper::sptr
-        psdu_mapper::make(Modulation m, bool short_sync)
+        psdu_mapper::make(Modulation m, bool short_sync, int queue_depth,
+                          int max_batch, int gap_len)
         {
             return gnuradio::get_initial_sptr
-                (new psdu_mapper_impl(m, short_sync));
+                (new psdu_mapper_impl(m, short_sync, queue_depth, max_batch, gap_len));
         }
 
 
         /*
          * The private constructor
          */
-        psdu_mapper_impl::psdu_mapper_impl(Modulation m, bool short_sync)
+        psdu_mapper_impl::psdu_mapper_impl(Modulation m, bool short_sync, int queue_depth,
+                                           int max_batch, int gap_len)
             : gr::block("psdu_mapper",
                         gr::io_signature::make(0, 0, 0),
                         gr::io_signature::make(1, 1, sizeof(char))),
             d_modulation(m),
             d_short_sync(short_sync),
-            d_ppdu_offset(0)
+            d_ppdu_offset(0),
+            d_max_batch(std::max(max_batch, 1)),
+            d_gap_len(std::max(gap_len, 0)),
+            d_gap_remaining(0),
+            d_ppdu_queue(std::max(queue_depth, 1)),
+            d_frames_dropped(0),
+            d_frames_received(0),
+            d_latency_tracing(false)
         {
             if (d_short_sync && m == DBPSK_1)
                 throw std::runtime_error("Short Sync cannot be used with 1Mbps BPSK");
 
             message_port_register_in(pmt::intern("psdu in"));        
+            set_msg_handler(pmt::intern("psdu in"),
+                            boost::bind(&psdu_mapper_impl::psdu_in, this, _1));
+            message_port_register_out(pmt::mp("stats"));
             set_tag_propagation_policy(block::TPP_DONT);
         }
 
@@ -84,33 +113,58 @@ namespace gr {
         }
 
         void psdu_mapper_impl::forecast(int noutput_items, gr_vector_int &ninput_items_required) {
-            int prefix_len = (d_short_sync ? 9 : 18) + PPDU_HEADER_LEN;
+            int prefix_len = ppdu_prefix_len(d_short_sync);
             ninput_items_required[0] = std::max(0, noutput_items - prefix_len);
         }
         
         void psdu_mapper_impl::psdu_in(pmt::pmt_t msg) {
-            gr::thread::scoped_lock lock(d_mutex);
+            uint64_t ingress_ns = d_latency_tracing ? latency_tracker::now_ns() : 0;
+            if (pmt::is_pair(msg)) msg = pmt::cdr(msg);
+
+            // The PLCP LENGTH field cannot describe longer PSDUs
+            if (pmt::blob_length(msg) > MAX_PSDU_LEN) {
+                d_frames_dropped++;
+                d_frames_received++;
+                return;
+            }
 
-            int psdu_len = pmt::blob_length(msg);
-            const char *psdu = static_cast<const char*>(pmt::blob_data(msg));
-
-            
-            int preamble_len = d_short_sync ? 9 : 18;
-            int prefix_len = preamble_len + PPDU_HEADER_LEN;
-            ppdu_info ppdu_i(prefix_len + psdu_len);
-
-            ppdu_i.mod_tags.push_back({0, DBPSK_1});
-            if (d_short_sync) {
-                insert_short_preamble(ppdu_i.ppdu);
-                ppdu_i.mod_tags.push_back({preamble_len, DQPSK_2});
-            } else {
-                insert_long_preamble(ppdu_i.ppdu);
+            // Message handlers run on the scheduler thread that also calls
+            // general_work, so waiting for a free slot would never end
+            if (d_ppdu_queue.full()) {
+                d_frames_dropped++;
+                d_frames_received++;
+                return;
             }
-            insert_header(ppdu_i.ppdu + preamble_len, psdu_len);
-            ppdu_i.mod_tags.push_back({prefix_len, d_modulation});
-            std::memcpy(ppdu_i.ppdu + prefix_len, psdu, psdu_len);
 
-            d_ppdu_queue.push(ppdu_i);
+            ppdu_info &ppdu_i = d_ppdu_queue.back_slot();
+            int psdu_len = pmt::blob_length(msg);
+            ppdu_i.psdu_blob = msg;
+            ppdu_i.psdu = static_cast<const unsigned char*>(pmt::blob_data(msg));
+            ppdu_i.prefix_len = ppdu_prefix_len(d_short_sync);
+            ppdu_i.ppdu_len = ppdu_i.prefix_len + psdu_len;
+            ppdu_i.ingress_ns = ingress_ns;
+            build_ppdu_prefix(d_modulation, d_short_sync, psdu_len,
+                              ppdu_i.prefix, ppdu_i.mod_tags, &d_header_cache);
+
+            d_ppdu_queue.push();
+            d_frames_received++;
+        }
+
+        void psdu_mapper_impl::add_ppdu_tags(const ppdu_info &ppdu_i, uint64_t offset) {
+            const pmt::pmt_t len_key = pmt::mp("ppdu_len");
+            const pmt::pmt_t val = pmt::from_long(ppdu_i.ppdu_len);
+            const pmt::pmt_t srcid = pmt::mp(alias());
+            add_item_tag(0, offset, len_key, val, srcid);
+
+            if (ppdu_i.ingress_ns)
+                add_item_tag(0, offset, pmt::mp("ppdu_time"),
+                             pmt::from_uint64(ppdu_i.ingress_ns), srcid);
+
+            const pmt::pmt_t mod_key = pmt::mp("mod_change");
+            for (auto& mod_tag : ppdu_i.mod_tags) {
+                const pmt::pmt_t val = pmt::from_long(mod_tag.second);
+                add_item_tag(0, offset + mod_tag.first, mod_key, val, srcid);
+            }
         }
 
         int
@@ -119,84 +173,50 @@ namespace gr {
                                         gr_vector_const_void_star &input_items,
                                         gr_vector_void_star &output_items)
         {
-            gr::thread::scoped_lock lock(d_mutex);
-            
             unsigned char *out = (unsigned char *) output_items[0];
-            if (!d_ppdu_queue.size()) return 0;
-            ppdu_info ppdu_i = d_ppdu_queue.front();
-            
-            if (d_ppdu_offset == 0) {
-                const pmt::pmt_t len_key = pmt::mp("ppdu_len");
-                const pmt::pmt_t val = pmt::from_long(ppdu_i.ppdu_len);
-                const pmt::pmt_t srcid = pmt::mp(alias());
-                add_item_tag(0, nitems_written(0), len_key, val, srcid);
-
-                const pmt::pmt_t mod_key = pmt::mp("mod_change");
-                for (auto& [rel_offset, m] : ppdu_i.mod_tags) {
-                    const pmt::pmt_t val = pmt::from_long(m);
-                    add_item_tag(0, nitems_written(0) + rel_offset, mod_key, val, srcid);
+            uint64_t stats_start = d_stats.begin();
+
+            int o = 0, n_frames = 0;
+            while (o < noutput_items) {
+                if (d_gap_remaining) {
+                    // code_mapper sends the tagged bytes as silence
+                    if (d_gap_remaining == d_gap_len)
+                        add_item_tag(0, nitems_written(0) + o, pmt::mp("gap"),
+                                     pmt::from_long(d_gap_len), pmt::mp(alias()));
+                    int n_gap = std::min(noutput_items - o, d_gap_remaining);
+                    std::memset(out + o, 0x00, n_gap);
+                    o += n_gap;
+                    d_gap_remaining -= n_gap;
+                    continue;
+                }
+                // Returning 0 while idle lets the scheduler sleep until the
+                // next message arrives on "psdu in".
+                if (n_frames == d_max_batch || d_ppdu_queue.empty()) break;
+
+                const ppdu_info &ppdu_i = d_ppdu_queue.front();
+                if (d_ppdu_offset == 0) {
+                    // Only the first PPDU of a call may be split
+                    if (o > 0 && ppdu_i.ppdu_len > noutput_items - o) break;
+                    add_ppdu_tags(ppdu_i, nitems_written(0) + o);
                 }
-            }
-
-            int n_bytes_send = std::min(noutput_items, ppdu_i.ppdu_len - d_ppdu_offset);
 
-            std::memcpy(out, ppdu_i.ppdu + d_ppdu_offset, n_bytes_send);
-            d_ppdu_offset += n_bytes_send;
+                int n_bytes_send = std::min(noutput_items - o, ppdu_i.ppdu_len - d_ppdu_offset);
+                ppdu_i.copy(out + o, d_ppdu_offset, n_bytes_send);
+                d_ppdu_offset += n_bytes_send;
+                o += n_bytes_send;
 
-            if (d_ppdu_offset == ppdu_i.ppdu_len) {
-                d_ppdu_offset = 0;
-                d_ppdu_queue.pop();
+                if (d_ppdu_offset == ppdu_i.ppdu_len) {
+                    d_ppdu_offset = 0;
+                    d_ppdu_queue.pop();
+                    d_gap_remaining = d_gap_len;
+                    n_frames++;
+                }
             }
-            
-            return n_bytes_send;
-        }
-
-        void psdu_mapper_impl::insert_long_preamble(unsigned char* buffer) {
-            std::memset(buffer, 0xFF, 16);
-            buffer[16] = 0xA0;
-            buffer[17] = 0xF3;
-        }
 
-        void psdu_mapper_impl::insert_short_preamble(unsigned char* buffer) {
-            std::memset(buffer, 0x00, 7);
-            buffer[7] = 0xCF;
-            buffer[8] = 0x05;
+            if (d_stats.end(stats_start, 0, o, d_ppdu_queue.depth() - d_ppdu_queue.space()))
+                message_port_pub(pmt::mp("stats"), d_stats.to_pmt());
+            return o;
         }
 
-        void psdu_mapper_impl::insert_header(unsigned char* buffer, unsigned int psdu_len) {
-            plcp_header header;
-            header.service = 0x00;
-            int doub_rate;
-            switch(d_modulation) {
-            case DBPSK_1:
-                header.signal = 0x0A;
-                doub_rate = 2;
-                break;
-            case DQPSK_2:
-                header.signal = 0x14;
-                doub_rate = 4;
-                break;
-            case CCK_5_5:
-                header.signal = 0x37;
-                doub_rate = 11;
-                break;
-            case CCK_11:
-                header.signal = 0x6E;
-                doub_rate = 22;
-                break;
-            default:
-                throw std::runtime_error("How did you get here?");
-                break;
-            }
-            int cmp = (16 * psdu_len) % doub_rate;
-            int deficit = cmp > 0 ? doub_rate - cmp : 0;
-            header.length = (16 * psdu_len + deficit) / doub_rate;
-            if (d_modulation == CCK_11 && deficit >= 16)
-                header.service |= 0x80;
-
-            header.calc_crc();
-            std::memcpy(buffer, &header, 4);
-        }
-        
     } /* namespace ieee802_11_b */
 } /* namespace gr */
@@ -21,30 +21,59 @@
 #ifndef INCLUDED_IEEE802_11_B_PSDU_MAPPER_IMPL_H
 #define INCLUDED_IEEE802_11_B_PSDU_MAPPER_IMPL_H
 
-#include <queue>
+#include <atomic>
 #include <utility>
 #include <vector>
 
 #include <ieee802_11_b/psdu_mapper.h>
-
-#define PPDU_HEADER_LEN 6
-
-struct plcp_header {
-    uint8_t signal;
-    uint8_t service;
-    uint16_t length;
-    uint16_t crc;
-
-    void calc_crc();
-}__attribute__((packed));
+#include "plcp.h"
+#include "latency_tracker.h"
+#include "work_stats.h"
 
 struct ppdu_info {
-    ppdu_info(int ppdu_len);
-    ~ppdu_info();
-    
     int ppdu_len;
-    unsigned char *ppdu;
+    int prefix_len;
+    unsigned char prefix[LONG_PREAMBLE_LEN + PPDU_HEADER_LEN];
+    // The PSDU is read straight from the incoming blob, which this
+    // reference keeps alive until the PPDU has been sent.
+    pmt::pmt_t psdu_blob;
+    const unsigned char *psdu;
     std::vector< std::pair<int, Modulation> > mod_tags;
+    // Arrival on "psdu in" on the latency_tracker clock, 0 if not traced
+    uint64_t ingress_ns;
+
+    // Copies n bytes of the PPDU starting at offset
+    void copy(unsigned char *out, int offset, int n) const;
+};
+
+/*
+ * Bounded single-producer/single-consumer FIFO of PPDUs that owns and
+ * recycles its slots. psdu_in builds frames in place in back_slot() and
+ * general_work reads them in place from front(); the two sides only
+ * synchronise through the head and tail counters, so no lock is taken and
+ * no allocation happens after construction.
+ */
+class ppdu_queue {
+public:
+    ppdu_queue(size_t depth);
+
+    size_t depth() const { return d_slots.size(); }
+
+    // Consumer side
+    bool empty() const;
+    ppdu_info &front() { return d_slots[d_head.load(std::memory_order_relaxed) % depth()]; }
+    void pop();
+
+    // Producer side
+    bool full() const;
+    size_t space() const;
+    ppdu_info &back_slot() { return d_slots[d_tail.load(std::memory_order_relaxed) % depth()]; }
+    void push();
+
+private:
+    std::vector<ppdu_info> d_slots;
+    std::atomic<size_t> d_head;
+    std::atomic<size_t> d_tail;
 };
 
 namespace gr {
@@ -53,7 +82,8 @@ namespace gr {
         class psdu_mapper_impl : public psdu_mapper
         {
         public:
-            psdu_mapper_impl(Modulation m, bool short_sync);
+            psdu_mapper_impl(Modulation m, bool short_sync, int queue_depth,
+                             int max_batch, int gap_len);
             ~psdu_mapper_impl();
 
             // Where all the action really happens
@@ -65,20 +95,39 @@ namespace gr {
                              gr_vector_void_star &output_items);
 
             void psdu_in(pmt::pmt_t msg);
+
+            int queue_depth() const { return d_ppdu_queue.depth(); }
+            uint64_t frames_dropped() const { return d_frames_dropped; }
+            uint64_t frames_received() const { return d_frames_received; }
+            int queue_space() const { return d_ppdu_queue.space(); }
+
+            void set_stats_enabled(bool enabled) { d_stats.set_enabled(enabled); }
+            bool stats_enabled() const { return d_stats.enabled(); }
+            pmt::pmt_t stats() const { return d_stats.to_pmt(); }
+            void reset_stats() { d_stats.reset(); }
+            void set_stats_interval(double seconds) { d_stats.set_interval(seconds); }
+
+            void set_latency_tracing(bool enabled) { d_latency_tracing = enabled; }
+            bool latency_tracing() const { return d_latency_tracing; }
 	  
         private:
             Modulation d_modulation;
             bool d_short_sync;
             int d_ppdu_offset;
-            std::queue<ppdu_info> d_ppdu_queue;
-            gr::thread::mutex d_mutex;
-
-            void insert_long_preamble(unsigned char* buffer);
+            int d_max_batch;
+            int d_gap_len;
+            int d_gap_remaining;
+            ppdu_queue d_ppdu_queue;
+            // Only touched by psdu_in
+            plcp_header_cache d_header_cache;
 
-            void insert_short_preamble(unsigned char* buffer);
+            std::atomic<uint64_t> d_frames_dropped;
+            std::atomic<uint64_t> d_frames_received;
 
-            void insert_header(unsigned char* buffer, unsigned int psdu_len);
+            work_stats d_stats;
+            std::atomic<bool> d_latency_tracing;
 
+            void add_ppdu_tags(const ppdu_info &ppdu_i, uint64_t offset);
         };
 
     } // namespace ieee802_11_b
@@ -0,0 +1,135 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2019 gr-ieee802_11_b author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gnuradio/io_signature.h>
+#include "pulse_shaper_impl.h"
+#include "chip_mapper.h"
+
+#include <stdexcept>
+
+#define CHIPS_PER_PACKED_BYTE 4
+
+namespace gr {
+    namespace ieee802_11_b {
+
+        pulse_shaper::sptr
+        pulse_shaper::make(int sps, const std::vector<float> &taps)
+        {
+            return gnuradio::get_initial_sptr
+                (new pulse_shaper_impl(sps, taps));
+        }
+
+        static int check_sps(int sps) {
+            if (sps < 1)
+                throw std::runtime_error("Samples per chip must be positive");
+            return sps;
+        }
+
+        pulse_shaper_impl::pulse_shaper_impl(int sps, const std::vector<float> &taps)
+            : gr::sync_interpolator("pulse_shaper",
+                                    gr::io_signature::make(1, 1, sizeof(unsigned char)),
+                                    gr::io_signature::make(1, 1, sizeof(gr_complex)),
+                                    CHIPS_PER_PACKED_BYTE * check_sps(sps)),
+            d_sps(sps),
+            d_taps(taps),
+            d_span((taps.size() + sps - 1) / sps),
+            d_groups((d_span + 3) / 4),
+            d_history(0),
+            d_n_chips(0)
+        {
+            if (taps.empty() || d_span > MAX_SPAN_CHIPS)
+                throw std::runtime_error("Filter must span 1 to 32 chips");
+
+            // Zero pad to whole groups so every lookup covers four chips
+            std::vector<float> padded(taps);
+            padded.resize(d_groups * 4 * sps, 0);
+            gr_complex points[4];
+            chip_mapper::phase_points(1.0f, points);
+
+            d_table.resize(d_groups * 256 * sps);
+            for (int g = 0; g < d_groups; ++g) {
+                for (int b = 0; b < 256; ++b) {
+                    gr_complex *entry = &d_table[(g * 256 + b) * sps];
+                    for (int j = 0; j < 4; ++j) {
+                        gr_complex point = points[(b >> (2 * j)) & 0x03];
+                        for (int s = 0; s < sps; ++s)
+                            entry[s] += point * padded[(4 * g + j) * sps + s];
+                    }
+                }
+            }
+        }
+
+        pulse_shaper_impl::~pulse_shaper_impl()
+        {
+        }
+
+        void pulse_shaper_impl::shape_chip (gr_complex *out) const {
+            const gr_complex *entry = &d_table[(d_history & 0xFF) * d_sps];
+            for (int s = 0; s < d_sps; ++s)
+                out[s] = entry[s];
+            for (int g = 1; g < d_groups; ++g) {
+                entry = &d_table[(g * 256 + ((d_history >> (8 * g)) & 0xFF)) * d_sps];
+                for (int s = 0; s < d_sps; ++s)
+                    out[s] += entry[s];
+            }
+        }
+
+        // Until the filter is full, there are no chips before the first one
+        void pulse_shaper_impl::shape_first_chips (gr_complex *out) const {
+            for (int s = 0; s < d_sps; ++s) {
+                out[s] = 0;
+                for (int k = 0; k < d_n_chips && k * d_sps + s < (int) d_taps.size(); ++k) {
+                    q_phase chip{(int) ((d_history >> (2 * k)) & 0x03)};
+                    out[s] += chip.to_complex() * d_taps[k * d_sps + s];
+                }
+            }
+        }
+
+        int
+        pulse_shaper_impl::work(int noutput_items,
+                                gr_vector_const_void_star &input_items,
+                                gr_vector_void_star &output_items)
+        {
+            const unsigned char *in = (const unsigned char *) input_items[0];
+            gr_complex *out = (gr_complex *) output_items[0];
+
+            const int n_bytes = noutput_items / (CHIPS_PER_PACKED_BYTE * d_sps);
+            for (int i = 0; i < n_bytes; ++i) {
+                for (int c = 0; c < CHIPS_PER_PACKED_BYTE; ++c) {
+                    d_history = (d_history << 2) | ((in[i] >> (2 * c)) & 0x03);
+                    if (d_n_chips < d_span) {
+                        d_n_chips++;
+                        shape_first_chips(out);
+                    } else {
+                        shape_chip(out);
+                    }
+                    out += d_sps;
+                }
+            }
+
+            return noutput_items;
+        }
+
+    } /* namespace ieee802_11_b */
+} /* namespace gr */
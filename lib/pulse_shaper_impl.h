@@ -0,0 +1,74 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2019 gr-ieee802_11_b author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_IEEE802_11_B_PULSE_SHAPER_IMPL_H
+#define INCLUDED_IEEE802_11_B_PULSE_SHAPER_IMPL_H
+
+#include <ieee802_11_b/pulse_shaper.h>
+
+#include <vector>
+
+// Chips of filter span the phase history can hold
+#define MAX_SPAN_CHIPS 32
+
+namespace gr {
+    namespace ieee802_11_b {
+
+        class pulse_shaper_impl : public pulse_shaper
+        {
+        public:
+            pulse_shaper_impl(int sps, const std::vector<float> &taps);
+            ~pulse_shaper_impl();
+
+            std::vector<float> taps() const { return d_taps; }
+
+            // Where all the action really happens
+            int work(int noutput_items,
+                     gr_vector_const_void_star &input_items,
+                     gr_vector_void_star &output_items);
+
+        private:
+            int d_sps;
+            std::vector<float> d_taps;
+            // Filter span in chips and in groups of four chips
+            int d_span;
+            int d_groups;
+
+            /*
+             * Entry (g * 256 + b) * sps + s is output phase s of the
+             * response to chips 4g..4g+3 back from the current one. Bits
+             * 2j..2j+1 of b hold the phase of chip 4g+j back, so the
+             * newest chip sits in the low bits as in d_history.
+             */
+            std::vector<gr_complex> d_table;
+
+            // Phases of the last MAX_SPAN_CHIPS chips, newest in bits 0-1
+            uint64_t d_history;
+            // Chips seen, saturating at the span
+            int d_n_chips;
+
+            void shape_chip(gr_complex *out) const;
+            void shape_first_chips(gr_complex *out) const;
+        };
+
+    } // namespace ieee802_11_b
+} // namespace gr
+
+#endif /* INCLUDED_IEEE802_11_B_PULSE_SHAPER_IMPL_H */
@@ -0,0 +1,87 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2019 gr-ieee802_11_b author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <gnuradio/attributes.h>
+#include <boost/test/unit_test.hpp>
+
+#include "plcp.h"
+
+#include <cstring>
+
+namespace gr {
+    namespace ieee802_11_b {
+
+        BOOST_AUTO_TEST_CASE(test_plcp_crc_table_matches_serial)
+        {
+            const Modulation mods[] = {DBPSK_1, DQPSK_2, CCK_5_5, CCK_11};
+            plcp_header_cache cache;
+
+            for (Modulation m : mods) {
+                for (unsigned int psdu_len = 0; psdu_len < 4096; ++psdu_len) {
+                    unsigned char header[PPDU_HEADER_LEN];
+                    insert_header(header, m, psdu_len);
+
+                    plcp_header ref;
+                    std::memcpy(&ref, header, PPDU_HEADER_LEN);
+                    uint16_t table_crc = ref.crc;
+                    ref.calc_crc_serial();
+                    BOOST_REQUIRE_EQUAL(table_crc, ref.crc);
+
+                    BOOST_REQUIRE(std::memcmp(cache.lookup(m, psdu_len),
+                                              header, PPDU_HEADER_LEN) == 0);
+                }
+            }
+        }
+
+        BOOST_AUTO_TEST_CASE(test_plcp_crc_covers_all_fields)
+        {
+            plcp_header a = {0x0A, 0x00, 0x0130, 0};
+            a.calc_crc();
+            for (int bit = 0; bit < 32; ++bit) {
+                plcp_header b = a;
+                reinterpret_cast<unsigned char*>(&b)[bit / 8] ^= 1 << (bit % 8);
+                b.calc_crc();
+                BOOST_CHECK(a.crc != b.crc);
+            }
+        }
+
+        BOOST_AUTO_TEST_CASE(test_plcp_parse_header_inverts_insert)
+        {
+            const Modulation mods[] = {DBPSK_1, DQPSK_2, CCK_5_5, CCK_11};
+
+            for (Modulation m : mods) {
+                for (int psdu_len = 0; psdu_len <= MAX_PSDU_LEN; ++psdu_len) {
+                    unsigned char header[PPDU_HEADER_LEN];
+                    insert_header(header, m, psdu_len);
+
+                    Modulation parsed_m;
+                    int parsed_len;
+                    BOOST_REQUIRE(parse_header(header, parsed_m, parsed_len));
+                    BOOST_REQUIRE_EQUAL(parsed_m, m);
+                    BOOST_REQUIRE_EQUAL(parsed_len, psdu_len);
+
+                    header[2] ^= 0x01;
+                    BOOST_REQUIRE(!parse_header(header, parsed_m, parsed_len));
+                }
+            }
+        }
+
+    } /* namespace ieee802_11_b */
+} /* namespace gr */
@@ -0,0 +1,194 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2019 gr-ieee802_11_b author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <gnuradio/attributes.h>
+#include <boost/test/unit_test.hpp>
+
+#include "scramble_kernels.h"
+#include "scrambler.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <stdexcept>
+#include <vector>
+
+namespace gr {
+    namespace ieee802_11_b {
+
+        // Every compiled kernel variant the running CPU can execute, so
+        // that the fallbacks are checked on wide machines too
+        static std::vector<descramble_kernel_t> descramble_kernels() {
+            std::vector<descramble_kernel_t> kernels = {descramble_generic};
+#if defined(__x86_64__) || defined(__i386__)
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("sse2"))
+                kernels.push_back(descramble_sse2);
+            if (__builtin_cpu_supports("avx2"))
+                kernels.push_back(descramble_avx2);
+#endif
+            return kernels;
+        }
+
+        static std::vector<scramble_lanes_kernel_t> scramble_lanes_kernels() {
+            std::vector<scramble_lanes_kernel_t> kernels = {scramble_lanes_generic};
+#if defined(__x86_64__) || defined(__i386__)
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("sse2"))
+                kernels.push_back(scramble_lanes_sse2);
+            if (__builtin_cpu_supports("avx2"))
+                kernels.push_back(scramble_lanes_avx2);
+#endif
+            return kernels;
+        }
+
+        BOOST_AUTO_TEST_CASE(test_descramble_kernels_match_serial)
+        {
+            // Lengths around the 16 and 64 byte strides of the SIMD loops
+            const int n = 1000;
+            std::vector<unsigned char> in(n + 1);
+            for (auto &b : in)
+                b = std::rand() & 0xFF;
+
+            // Bit-serial reference on the LSB-first bit stream, seeded
+            // with the byte before the buffer like the kernels
+            std::vector<unsigned char> ref(n);
+            int state = 0;
+            for (int b = 0; b < 8; ++b)
+                state = ((state << 1) & 0x7F) | ((in[0] >> b) & 1);
+            for (int i = 0; i < n; ++i) {
+                for (int b = 0; b < 8; ++b) {
+                    int bit_in = (in[i + 1] >> b) & 1;
+                    int bit_out = bit_in ^ ((state >> 3) & 1) ^ ((state >> 6) & 1);
+                    ref[i] |= bit_out << b;
+                    state = ((state << 1) & 0x7F) | bit_in;
+                }
+            }
+
+            for (descramble_kernel_t kernel : descramble_kernels()) {
+                for (int len : {0, 1, 15, 16, 17, 63, 64, 65, 200, n}) {
+                    std::vector<unsigned char> out(len);
+                    kernel(in.data() + 1, out.data(), len);
+                    BOOST_REQUIRE(std::equal(out.begin(), out.end(), ref.begin()));
+                }
+            }
+        }
+
+        BOOST_AUTO_TEST_CASE(test_scrambler_jump_matches_zero_input)
+        {
+            for (bool reverse : {false, true}) {
+                scrambler scr(reverse);
+                const unsigned char zero = 0;
+                unsigned char out;
+
+                for (int state = 0; state < 128; ++state) {
+                    scr.set_state(state);
+                    for (int n_bytes = 0; n_bytes < 300; ++n_bytes) {
+                        BOOST_REQUIRE_EQUAL(scr.jump(state, 8 * n_bytes), scr.state());
+                        scr.process(&zero, &out, 1);
+                    }
+                }
+
+                // The scrambler repeats every 127 bits, the descrambler
+                // forgets its state after 7
+                const uint64_t n_bits = 127ull * 1000000007ull;
+                for (int state = 0; state < 128; ++state) {
+                    for (int extra = 0; extra < 8; ++extra) {
+                        int expected = reverse ? 0 : scr.jump(state, extra);
+                        BOOST_REQUIRE_EQUAL(scr.jump(state, n_bits + extra), expected);
+                    }
+                }
+            }
+        }
+
+        BOOST_AUTO_TEST_CASE(test_scrambler_parallel_matches_serial)
+        {
+            const size_t sizes[] = {1, 1000, 1 << 16, (1 << 17) + 1, 1000003};
+            std::vector<unsigned char> in(1000003);
+            for (size_t i = 0; i < in.size(); ++i)
+                in[i] = std::rand() & 0xFF;
+
+            for (int n_threads : {0, 1, 3, 7}) {
+                chunk_pool pool(n_threads);
+                for (bool reverse : {false, true}) {
+                    for (size_t n : sizes) {
+                        scrambler ref(reverse), par(reverse);
+                        std::vector<unsigned char> ref_out(n), par_out(n);
+
+                        // Twice, so the second call starts from a carried state
+                        for (int pass = 0; pass < 2; ++pass) {
+                            ref.process(in.data(), ref_out.data(), n);
+                            par.process_parallel(in.data(), par_out.data(), n, pool);
+                            BOOST_REQUIRE(ref_out == par_out);
+                            BOOST_REQUIRE_EQUAL(ref.state(), par.state());
+                        }
+                    }
+                }
+            }
+        }
+
+        BOOST_AUTO_TEST_CASE(test_chunk_pool_propagates_task_error)
+        {
+            for (int n_threads : {0, 3}) {
+                chunk_pool pool(n_threads);
+                BOOST_CHECK_THROW(pool.run(64, [](int i) {
+                    if (i == 5)
+                        throw std::runtime_error("task failed");
+                }), std::runtime_error);
+
+                // The pool stays usable after a failed batch
+                std::vector<int> done(64, 0);
+                pool.run(64, [&done](int i) { done[i] = 1; });
+                BOOST_CHECK(std::count(done.begin(), done.end(), 1) == 64);
+            }
+        }
+
+        BOOST_AUTO_TEST_CASE(test_scramble_lanes_match_scrambler)
+        {
+            const int n_lanes = 77;
+            std::vector<scrambler> refs(n_lanes, scrambler(false));
+            std::vector<unsigned char> prev(n_lanes), in(n_lanes);
+
+            // Lane i starts from state i; its previous output byte holds
+            // the state bits in reverse order
+            for (int i = 0; i < n_lanes; ++i) {
+                refs[i].set_state(i);
+                for (int k = 0; k < 7; ++k)
+                    if (i & (1 << k))
+                        prev[i] |= 0x80 >> k;
+            }
+
+            for (scramble_lanes_kernel_t kernel : scramble_lanes_kernels()) {
+                std::vector<scrambler> lane_refs(refs);
+                std::vector<unsigned char> lane_prev(prev);
+                for (int step = 0; step < 1000; ++step) {
+                    for (int i = 0; i < n_lanes; ++i)
+                        in[i] = std::rand() & 0xFF;
+                    kernel(lane_prev.data(), in.data(), n_lanes);
+                    for (int i = 0; i < n_lanes; ++i) {
+                        unsigned char out;
+                        lane_refs[i].process(&in[i], &out, 1);
+                        BOOST_REQUIRE_EQUAL(out, lane_prev[i]);
+                    }
+                }
+            }
+        }
+
+    } /* namespace ieee802_11_b */
+} /* namespace gr */
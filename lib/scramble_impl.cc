@@ -25,8 +25,6 @@
 #include <gnuradio/io_signature.h>
 #include "scramble_impl.h"
 
-#define INITIAL_STATE 0x1b
-
 namespace gr {
     namespace ieee802_11_b {
 
@@ -41,9 +39,9 @@ namespace gr {
             : gr::sync_block("scramble",
                              gr::io_signature::make(1, 1, sizeof(char)),
                              gr::io_signature::make(1, 1, sizeof(char))),
-            d_reverse(reverse),
-            d_state(reverse ? 0 : INITIAL_STATE)
+            d_scrambler(reverse)
         {
+            message_port_register_out(pmt::mp("stats"));
         }
 
         scramble_impl::~scramble_impl()
@@ -57,39 +55,24 @@ namespace gr {
         {
             const unsigned char *bytes_in = (const unsigned char *) input_items[0];
             unsigned char *bytes_out = (unsigned char *) output_items[0];
+            uint64_t stats_start = d_stats.begin();
 
-            int s_offset = nitems_read(0);
-            get_tags_in_range(d_tags, 0, s_offset, s_offset + noutput_items);
+            uint64_t s_offset = nitems_read(0);
+            get_tags_in_range(d_tags, 0, s_offset, s_offset + noutput_items,
+                              pmt::mp("ppdu_len"));
+            std::sort(d_tags.begin(), d_tags.end(), gr::tag_t::offset_compare);
 
-            int rel_frame_s = -1, tags_idx = -1;
-            if (d_tags.size()) {
-                std::sort(d_tags.begin(), d_tags.end(), gr::tag_t::offset_compare);
-                rel_frame_s = d_tags[0].offset - s_offset;
-                ++tags_idx;
+            int i = 0;
+            for (const gr::tag_t& tag : d_tags) {
+                int rel_frame_s = tag.offset - s_offset;
+                d_scrambler.process(bytes_in + i, bytes_out + i, rel_frame_s - i);
+                d_scrambler.reset();
+                i = rel_frame_s;
             }
-            
-            for (int i = 0; i < noutput_items; ++i) {
+            d_scrambler.process(bytes_in + i, bytes_out + i, noutput_items - i);
 
-                if (i == rel_frame_s) {
-                    d_state = d_reverse ? 0 : INITIAL_STATE;
-                    if (tags_idx < d_tags.size() - 1)
-                        rel_frame_s = d_tags[++tags_idx].offset - s_offset;
-                }
-                bytes_out[i] = 0;
-                for (int b = 0; b < 8; ++b) {
-                    unsigned char bit_in, bit_out;
-                    bit_in = (bytes_in[i] >> b) & 0x01;
-                    unsigned char feedback = !!(d_state & (1 << 3)) ^ !!(d_state & (1 << 6));
-                    bit_out = bit_in ^ feedback;
-                    d_state = ((d_state << 1) & ((1 << 7) - 1));
-                    if (d_reverse)
-                        d_state |= bit_in;
-                    else
-                        d_state |= bit_out;
-                    bytes_out[i] |= (bit_out << b);
-                }
-            }
-            
+            if (d_stats.end(stats_start, noutput_items, noutput_items, 0))
+                message_port_pub(pmt::mp("stats"), d_stats.to_pmt());
             return noutput_items;
         }
 
@@ -22,6 +22,8 @@
 #define INCLUDED_IEEE802_11_B_SCRAMBLE_IMPL_H
 
 #include <ieee802_11_b/scramble.h>
+#include "scrambler.h"
+#include "work_stats.h"
 
 namespace gr {
     namespace ieee802_11_b {
@@ -38,10 +40,16 @@ namespace gr {
                 gr_vector_const_void_star &input_items,
                 gr_vector_void_star &output_items
                 );
+
+            void set_stats_enabled(bool enabled) { d_stats.set_enabled(enabled); }
+            bool stats_enabled() const { return d_stats.enabled(); }
+            pmt::pmt_t stats() const { return d_stats.to_pmt(); }
+            void reset_stats() { d_stats.reset(); }
+            void set_stats_interval(double seconds) { d_stats.set_interval(seconds); }
         private:
-            bool d_reverse;
-            int d_state;
+            scrambler d_scrambler;
             std::vector<gr::tag_t> d_tags;
+            work_stats d_stats;
         };
 
       
@@ -0,0 +1,171 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2019 gr-ieee802_11_b author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "scramble_kernels.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+static inline unsigned char descramble_byte(unsigned char cur, unsigned char prv) {
+    unsigned char d4 = (cur << 4) | (prv >> 4);
+    unsigned char d7 = (cur << 7) | (prv >> 1);
+    return cur ^ d4 ^ d7;
+}
+
+void descramble_generic(const unsigned char *in, unsigned char *out, int n) {
+    for (int i = 0; i < n; ++i)
+        out[i] = descramble_byte(in[i], in[i - 1]);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+__attribute__((target("sse2")))
+void descramble_sse2(const unsigned char *in, unsigned char *out, int n) {
+    // x86 has no per-byte shifts, so shift 16-bit lanes and mask off the
+    // bits that crossed into the neighbouring byte.
+    const __m128i m_hi4 = _mm_set1_epi8((char) 0xF0);
+    const __m128i m_lo4 = _mm_set1_epi8(0x0F);
+    const __m128i m_hi1 = _mm_set1_epi8((char) 0x80);
+    const __m128i m_lo7 = _mm_set1_epi8(0x7F);
+
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i cur = _mm_loadu_si128((const __m128i *) (in + i));
+        __m128i prv = _mm_loadu_si128((const __m128i *) (in + i - 1));
+        __m128i d4 = _mm_or_si128(_mm_and_si128(_mm_slli_epi16(cur, 4), m_hi4),
+                                  _mm_and_si128(_mm_srli_epi16(prv, 4), m_lo4));
+        __m128i d7 = _mm_or_si128(_mm_and_si128(_mm_slli_epi16(cur, 7), m_hi1),
+                                  _mm_and_si128(_mm_srli_epi16(prv, 1), m_lo7));
+        _mm_storeu_si128((__m128i *) (out + i),
+                         _mm_xor_si128(cur, _mm_xor_si128(d4, d7)));
+    }
+    descramble_generic(in + i, out + i, n - i);
+}
+
+__attribute__((target("avx2")))
+void descramble_avx2(const unsigned char *in, unsigned char *out, int n) {
+    const __m256i m_hi4 = _mm256_set1_epi8((char) 0xF0);
+    const __m256i m_lo4 = _mm256_set1_epi8(0x0F);
+    const __m256i m_hi1 = _mm256_set1_epi8((char) 0x80);
+    const __m256i m_lo7 = _mm256_set1_epi8(0x7F);
+
+    int i = 0;
+    // Two independent 32-byte lanes per iteration to hide load latency.
+    for (; i + 64 <= n; i += 64) {
+        for (int j = 0; j < 64; j += 32) {
+            __m256i cur = _mm256_loadu_si256((const __m256i *) (in + i + j));
+            __m256i prv = _mm256_loadu_si256((const __m256i *) (in + i + j - 1));
+            __m256i d4 = _mm256_or_si256(_mm256_and_si256(_mm256_slli_epi16(cur, 4), m_hi4),
+                                         _mm256_and_si256(_mm256_srli_epi16(prv, 4), m_lo4));
+            __m256i d7 = _mm256_or_si256(_mm256_and_si256(_mm256_slli_epi16(cur, 7), m_hi1),
+                                         _mm256_and_si256(_mm256_srli_epi16(prv, 1), m_lo7));
+            _mm256_storeu_si256((__m256i *) (out + i + j),
+                                _mm256_xor_si256(cur, _mm256_xor_si256(d4, d7)));
+        }
+    }
+    descramble_sse2(in + i, out + i, n - i);
+}
+
+#endif
+
+descramble_kernel_t descramble_kernel_select() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return descramble_avx2;
+    if (__builtin_cpu_supports("sse2"))
+        return descramble_sse2;
+#endif
+    return descramble_generic;
+}
+
+// The low nibble only depends on the previous byte; the high one also
+// on the low nibble, which is fed back once it is known.
+static inline unsigned char scramble_byte(unsigned char in, unsigned char prv) {
+    unsigned char t = in ^ (prv >> 4) ^ (prv >> 1);
+    unsigned char lo = t & 0x0F;
+    return t ^ (lo << 4) ^ (lo << 7);
+}
+
+void scramble_lanes_generic(unsigned char *prev, const unsigned char *in, int n) {
+    for (int i = 0; i < n; ++i)
+        prev[i] = scramble_byte(in[i], prev[i]);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+__attribute__((target("sse2")))
+void scramble_lanes_sse2(unsigned char *prev, const unsigned char *in, int n) {
+    const __m128i m_lo4 = _mm_set1_epi8(0x0F);
+    const __m128i m_hi1 = _mm_set1_epi8((char) 0x80);
+    const __m128i m_lo7 = _mm_set1_epi8(0x7F);
+
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i x = _mm_loadu_si128((const __m128i *) (in + i));
+        __m128i p = _mm_loadu_si128((const __m128i *) (prev + i));
+        __m128i t = _mm_xor_si128(x, _mm_xor_si128(_mm_and_si128(_mm_srli_epi16(p, 4), m_lo4),
+                                                   _mm_and_si128(_mm_srli_epi16(p, 1), m_lo7)));
+        __m128i lo = _mm_and_si128(t, m_lo4);
+        t = _mm_xor_si128(t, _mm_xor_si128(_mm_slli_epi16(lo, 4),
+                                           _mm_and_si128(_mm_slli_epi16(lo, 7), m_hi1)));
+        _mm_storeu_si128((__m128i *) (prev + i), t);
+    }
+    scramble_lanes_generic(prev + i, in + i, n - i);
+}
+
+__attribute__((target("avx2")))
+void scramble_lanes_avx2(unsigned char *prev, const unsigned char *in, int n) {
+    const __m256i m_lo4 = _mm256_set1_epi8(0x0F);
+    const __m256i m_hi1 = _mm256_set1_epi8((char) 0x80);
+    const __m256i m_lo7 = _mm256_set1_epi8(0x7F);
+
+    int i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i x = _mm256_loadu_si256((const __m256i *) (in + i));
+        __m256i p = _mm256_loadu_si256((const __m256i *) (prev + i));
+        __m256i t = _mm256_xor_si256(x, _mm256_xor_si256(
+                                         _mm256_and_si256(_mm256_srli_epi16(p, 4), m_lo4),
+                                         _mm256_and_si256(_mm256_srli_epi16(p, 1), m_lo7)));
+        __m256i lo = _mm256_and_si256(t, m_lo4);
+        t = _mm256_xor_si256(t, _mm256_xor_si256(_mm256_slli_epi16(lo, 4),
+                                                 _mm256_and_si256(_mm256_slli_epi16(lo, 7), m_hi1)));
+        _mm256_storeu_si256((__m256i *) (prev + i), t);
+    }
+    scramble_lanes_sse2(prev + i, in + i, n - i);
+}
+
+#endif
+
+scramble_lanes_kernel_t scramble_lanes_kernel_select() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return scramble_lanes_avx2;
+    if (__builtin_cpu_supports("sse2"))
+        return scramble_lanes_sse2;
+#endif
+    return scramble_lanes_generic;
+}
@@ -0,0 +1,70 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2019 gr-ieee802_11_b author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_IEEE802_11_B_SCRAMBLE_KERNELS_H
+#define INCLUDED_IEEE802_11_B_SCRAMBLE_KERNELS_H
+
+/*
+ * Bulk descrambler kernels.
+ *
+ * The self-synchronising descrambler output is
+ *     out[k] = in[k] ^ in[k - 4] ^ in[k - 7]
+ * on the LSB-first bit stream, so each output byte only depends on the
+ * input byte at the same position and the one before it. All kernels
+ * compute out[0 .. n) and read in[-1 .. n), i.e. the byte preceding
+ * `in` must be valid.
+ */
+typedef void (*descramble_kernel_t)(const unsigned char *in,
+                                    unsigned char *out, int n);
+
+void descramble_generic(const unsigned char *in, unsigned char *out, int n);
+
+#if defined(__x86_64__) || defined(__i386__)
+void descramble_sse2(const unsigned char *in, unsigned char *out, int n);
+
+void descramble_avx2(const unsigned char *in, unsigned char *out, int n);
+#endif
+
+// Picks the widest kernel supported by the running CPU.
+descramble_kernel_t descramble_kernel_select();
+
+/*
+ * Lane-parallel transmit scrambler kernels.
+ *
+ * Steps n independent scramblers by one byte each. The scrambler output
+ * is
+ *     out[k] = in[k] ^ out[k - 4] ^ out[k - 7]
+ * so the state of a lane is its previous output byte. Lane i scrambles
+ * in[i] with the state prev[i] and stores the scrambled byte in prev[i].
+ */
+typedef void (*scramble_lanes_kernel_t)(unsigned char *prev,
+                                        const unsigned char *in, int n);
+
+void scramble_lanes_generic(unsigned char *prev, const unsigned char *in, int n);
+
+#if defined(__x86_64__) || defined(__i386__)
+void scramble_lanes_sse2(unsigned char *prev, const unsigned char *in, int n);
+
+void scramble_lanes_avx2(unsigned char *prev, const unsigned char *in, int n);
+#endif
+
+scramble_lanes_kernel_t scramble_lanes_kernel_select();
+
+#endif /* INCLUDED_IEEE802_11_B_SCRAMBLE_KERNELS_H */
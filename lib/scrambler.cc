@@ -0,0 +1,196 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2019 gr-ieee802_11_b author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "scrambler.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace gr {
+    namespace ieee802_11_b {
+
+        // Chunk sizes for process_parallel: below the minimum a chunk is not
+        // worth a thread, the maximum keeps the kernels' int counts in range
+        static const size_t MIN_CHUNK = 1 << 16;
+        static const size_t MAX_CHUNK = 1 << 28;
+
+        // Keystream period in bytes: the LFSR repeats after 127 bits
+        static const int KEYSTREAM_PERIOD = 127;
+
+        // Product of the GF(2) matrix with the given columns and v
+        static int mat_apply(const uint8_t cols[7], int v) {
+            int r = 0;
+            for (int j = 0; j < 7; ++j)
+                if (v & (1 << j))
+                    r ^= cols[j];
+            return r;
+        }
+
+        scrambler::scrambler(bool reverse)
+            : d_reverse(reverse),
+              d_state(reverse ? 0 : INITIAL_STATE),
+              d_descramble(descramble_kernel_select())
+        {
+            build_tables();
+        }
+
+        void scrambler::reset() {
+            d_state = d_reverse ? 0 : INITIAL_STATE;
+        }
+
+        uint16_t scrambler::step_byte_serial(int state, unsigned char byte) const {
+            unsigned char out = 0;
+            for (int b = 0; b < 8; ++b) {
+                unsigned char bit_in, bit_out;
+                bit_in = (byte >> b) & 0x01;
+                unsigned char feedback = !!(state & (1 << 3)) ^ !!(state & (1 << 6));
+                bit_out = bit_in ^ feedback;
+                state = ((state << 1) & ((1 << 7) - 1));
+                if (d_reverse)
+                    state |= bit_in;
+                else
+                    state |= bit_out;
+                out |= (bit_out << b);
+            }
+            return out | (state << 8);
+        }
+
+        void scrambler::build_tables() {
+            for (int s = 0; s < 128; ++s)
+                d_state_table[s] = step_byte_serial(s, 0);
+            for (int b = 0; b < 256; ++b)
+                d_byte_table[b] = step_byte_serial(0, b);
+
+            // One zero bit shifts the state left and, in the scrambler,
+            // feeds back x^4 + x^7; the descrambler shifts in the zero
+            for (int j = 0; j < 7; ++j) {
+                int state = 1 << j;
+                int feedback = !!(state & (1 << 3)) ^ !!(state & (1 << 6));
+                d_jump[0][j] = ((state << 1) & ((1 << 7) - 1)) | (d_reverse ? 0 : feedback);
+            }
+            for (int k = 1; k < 64; ++k)
+                for (int j = 0; j < 7; ++j)
+                    d_jump[k][j] = mat_apply(d_jump[k - 1], d_jump[k - 1][j]);
+        }
+
+        int scrambler::jump(int state, uint64_t n_bits) const {
+            for (int k = 0; n_bits; ++k, n_bits >>= 1)
+                if (n_bits & 1)
+                    state = mat_apply(d_jump[k], state);
+            return state;
+        }
+
+        int scrambler::scramble_run(int state, const unsigned char *in,
+                                    unsigned char *out, size_t n) const {
+            for (size_t i = 0; i < n; ++i) {
+                uint16_t r = d_state_table[state] ^ d_byte_table[in[i]];
+                out[i] = r & 0xFF;
+                state = r >> 8;
+            }
+            return state;
+        }
+
+        void scrambler::apply_keystream(int state, unsigned char *out, size_t n) const {
+            unsigned char keystream[KEYSTREAM_PERIOD];
+            for (int i = 0; i < KEYSTREAM_PERIOD; ++i) {
+                keystream[i] = d_state_table[state] & 0xFF;
+                state = d_state_table[state] >> 8;
+            }
+            for (size_t i = 0; i < n; i += KEYSTREAM_PERIOD) {
+                size_t len = std::min<size_t>(KEYSTREAM_PERIOD, n - i);
+                for (size_t j = 0; j < len; ++j)
+                    out[i + j] ^= keystream[j];
+            }
+        }
+
+        void scrambler::process(const unsigned char *in, unsigned char *out, int n) {
+            if (n <= 0) return;
+
+            if (d_reverse) {
+                // The first byte depends on the carried state; every byte
+                // after it only depends on the input, which the kernel reads
+                // directly. The descrambler state is the last 7 input bits.
+                uint16_t r = d_state_table[d_state] ^ d_byte_table[in[0]];
+                out[0] = r & 0xFF;
+                d_descramble(in + 1, out + 1, n - 1);
+                d_state = d_byte_table[in[n - 1]] >> 8;
+                return;
+            }
+
+            // The transmit scrambler feeds its output back into the LFSR, so
+            // its keystream is data dependent and stays byte-serial.
+            d_state = scramble_run(d_state, in, out, n);
+        }
+
+        void scrambler::process_parallel(const unsigned char *in, unsigned char *out,
+                                         size_t n, chunk_pool &pool) {
+            size_t n_chunks = std::min<size_t>(pool.size(), n / MIN_CHUNK);
+            n_chunks = std::max(n_chunks, (n + MAX_CHUNK - 1) / MAX_CHUNK);
+            if (n_chunks <= 1) {
+                process(in, out, n);
+                return;
+            }
+
+            auto chunk_start = [n, n_chunks](size_t i) { return n * i / n_chunks; };
+
+            if (d_reverse) {
+                const int first_state = d_state;
+                pool.run(n_chunks, [&](int i) {
+                    size_t start = chunk_start(i), len = chunk_start(i + 1) - start;
+                    if (i == 0) {
+                        // Only the first byte depends on the carried state
+                        out[0] = (d_state_table[first_state] ^ d_byte_table[in[0]]) & 0xFF;
+                        d_descramble(in + 1, out + 1, len - 1);
+                    } else {
+                        d_descramble(in + start, out + start, len);
+                    }
+                });
+                d_state = d_byte_table[in[n - 1]] >> 8;
+                return;
+            }
+
+            // The state after a chunk is the jump of its starting state
+            // over the chunk XOR the state its data leaves behind from 0,
+            // and the output is the output from 0 XOR the keystream of the
+            // starting state.
+            std::vector<int> states(n_chunks + 1);
+            states[0] = d_state;
+            pool.run(n_chunks, [&](int i) {
+                size_t start = chunk_start(i), len = chunk_start(i + 1) - start;
+                states[i + 1] = scramble_run(i ? 0 : states[0], in + start, out + start, len);
+            });
+            for (size_t i = 1; i < n_chunks; ++i) {
+                uint64_t n_bits = 8 * (chunk_start(i + 1) - chunk_start(i));
+                states[i + 1] ^= jump(states[i], n_bits);
+            }
+            pool.run(n_chunks - 1, [&](int i) {
+                size_t start = chunk_start(i + 1), len = chunk_start(i + 2) - start;
+                if (states[i + 1])
+                    apply_keystream(states[i + 1], out + start, len);
+            });
+            d_state = states[n_chunks];
+        }
+
+    } /* namespace ieee802_11_b */
+} /* namespace gr */
@@ -0,0 +1,95 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2019 gr-ieee802_11_b author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_IEEE802_11_B_SCRAMBLER_H
+#define INCLUDED_IEEE802_11_B_SCRAMBLER_H
+
+#include "chunk_pool.h"
+#include "scramble_kernels.h"
+
+#include <cstddef>
+#include <cstdint>
+
+#define INITIAL_STATE 0x1b
+
+namespace gr {
+    namespace ieee802_11_b {
+
+        /*
+         * x^7 + x^4 + 1 self-synchronising (de)scrambler, stepped a byte at
+         * a time. Shared by the scramble block and the fused encoders.
+         */
+        class scrambler
+        {
+        public:
+            scrambler(bool reverse);
+
+            void reset();
+
+            void process(const unsigned char *in, unsigned char *out, int n);
+
+            // Same output and final state as process(), with the buffer cut
+            // in chunks that are processed on the pool. The descrambler
+            // seeds each chunk from the input byte before it; the scrambler
+            // runs every chunk from state 0 and then corrects it with the
+            // keystream of its real starting state, found by jump-ahead.
+            void process_parallel(const unsigned char *in, unsigned char *out,
+                                  size_t n, chunk_pool &pool);
+
+            int state() const { return d_state; }
+            void set_state(int state) { d_state = state; }
+
+            // State after n_bits zero input bits, in O(log n_bits)
+            int jump(int state, uint64_t n_bits) const;
+            void advance(uint64_t n_bits) { d_state = jump(d_state, n_bits); }
+
+        private:
+            bool d_reverse;
+            int d_state;
+
+            // Each entry packs the output byte (low 8 bits) and the
+            // resulting LFSR state (high bits).  The scrambler is linear
+            // over GF(2), so stepping a full byte is the XOR of the
+            // contributions of the current state and of the input byte.
+            uint16_t d_state_table[128];
+            uint16_t d_byte_table[256];
+
+            // Columns of the one-bit, zero-input state transition matrix
+            // raised to the powers 2^k
+            uint8_t d_jump[64][7];
+
+            // Vectorized bulk path, only used for descrambling
+            descramble_kernel_t d_descramble;
+
+            uint16_t step_byte_serial(int state, unsigned char byte) const;
+
+            // Scrambles n bytes from state, returns the final state
+            int scramble_run(int state, const unsigned char *in,
+                             unsigned char *out, size_t n) const;
+
+            // XORs the zero-input keystream of state onto n bytes
+            void apply_keystream(int state, unsigned char *out, size_t n) const;
+
+            void build_tables();
+        };
+
+    } // namespace ieee802_11_b
+} // namespace gr
+
+#endif /* INCLUDED_IEEE802_11_B_SCRAMBLER_H */
@@ -0,0 +1,323 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2019 gr-ieee802_11_b author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gnuradio/io_signature.h>
+#include "tx_frame_encoder_impl.h"
+
+// out = in * exp(j * pi/2 * ph)
+static void rotate_chips(const gr_complex *in, gr_complex *out, int n, q_phase ph) {
+    switch(ph.ph) {
+    case 0:
+        std::memcpy(out, in, n * sizeof(gr_complex));
+        break;
+    case 1:
+        for (int i = 0; i < n; ++i)
+            out[i] = gr_complex(-in[i].imag(), in[i].real());
+        break;
+    case 2:
+        for (int i = 0; i < n; ++i)
+            out[i] = -in[i];
+        break;
+    default:
+        for (int i = 0; i < n; ++i)
+            out[i] = gr_complex(in[i].imag(), -in[i].real());
+        break;
+    }
+}
+
+namespace gr {
+    namespace ieee802_11_b {
+
+        tx_frame_encoder::sptr
+        tx_frame_encoder::make(Modulation m, bool short_sync, int queue_depth,
+                               int n_threads)
+        {
+            return gnuradio::get_initial_sptr
+                (new tx_frame_encoder_impl(m, short_sync, queue_depth, n_threads));
+        }
+
+        tx_frame_encoder_impl::tx_frame_encoder_impl(Modulation m, bool short_sync,
+                                                     int queue_depth, int n_threads)
+            : gr::block("tx_frame_encoder",
+                        gr::io_signature::make(0, 0, 0),
+                        gr::io_signature::make(1, 1, sizeof(gr_complex))),
+            d_modulation(m),
+            d_short_sync(short_sync),
+            d_n_threads(n_threads),
+            // Every frame queued for the workers holds its spread chips
+            d_queue_depth(std::max(n_threads ? std::min(queue_depth, 4 * n_threads)
+                                             : queue_depth, 1)),
+            d_coder(short_sync),
+            d_stage(FRAME_START),
+            d_segment(nullptr),
+            d_chip_offset(0),
+            d_byte_offset(0),
+            d_carry_len(0),
+            d_carry_pos(0),
+            d_stopping(true),
+            d_queued(0),
+            d_frames_dropped(0),
+            d_frames_received(0)
+        {
+            if (d_short_sync && m == DBPSK_1)
+                throw std::runtime_error("Short Sync cannot be used with 1Mbps BPSK");
+            if (n_threads < 0)
+                throw std::runtime_error("Number of threads cannot be negative");
+
+            message_port_register_in(pmt::intern("psdu in"));
+            set_msg_handler(pmt::intern("psdu in"),
+                            boost::bind(&tx_frame_encoder_impl::psdu_in, this, _1));
+            set_tag_propagation_policy(block::TPP_DONT);
+        }
+
+        tx_frame_encoder_impl::~tx_frame_encoder_impl()
+        {
+            {
+                gr::thread::scoped_lock lock(d_mutex);
+                d_stopping = true;
+                d_pending_cond.notify_all();
+            }
+            d_workers.join_all();
+        }
+
+        bool tx_frame_encoder_impl::start() {
+            {
+                gr::thread::scoped_lock lock(d_mutex);
+                d_stopping = false;
+            }
+            for (int i = 0; i < d_n_threads; ++i)
+                d_workers.create_thread(boost::bind(&tx_frame_encoder_impl::worker, this));
+            return block::start();
+        }
+
+        bool tx_frame_encoder_impl::stop() {
+            {
+                gr::thread::scoped_lock lock(d_mutex);
+                d_stopping = true;
+                d_pending_cond.notify_all();
+                d_done_cond.notify_all();
+            }
+            d_workers.join_all();
+            return block::stop();
+        }
+
+        void tx_frame_encoder_impl::worker() {
+            frame_coder coder(d_short_sync);
+
+            gr::thread::scoped_lock lock(d_mutex);
+            for (;;) {
+                while (d_pending.empty() && !d_stopping)
+                    d_pending_cond.wait(lock);
+                if (d_stopping)
+                    return;
+
+                std::shared_ptr<tx_job> job = d_pending.front();
+                d_pending.pop_front();
+
+                lock.unlock();
+                coder.scramble_psdu(job->frame);
+                job->chips.resize(job->frame.n_chips);
+                job->end_phase = coder.encode(job->frame, q_phase{0}, job->chips.data());
+                lock.lock();
+
+                job->done = true;
+                d_done_cond.notify_all();
+            }
+        }
+
+        void tx_frame_encoder_impl::psdu_in(pmt::pmt_t msg) {
+            if (pmt::is_pair(msg)) msg = pmt::cdr(msg);
+
+            int psdu_len = pmt::blob_length(msg);
+            // The PLCP LENGTH field cannot describe longer PSDUs
+            if (psdu_len > MAX_PSDU_LEN || d_queued >= d_queue_depth) {
+                d_frames_dropped++;
+                d_frames_received++;
+                return;
+            }
+            // Only psdu_in takes slots, so the one checked above is still free
+            d_queued++;
+            d_frames_received++;
+            const unsigned char *psdu = static_cast<const unsigned char*>(pmt::blob_data(msg));
+            if (d_n_threads) {
+                std::shared_ptr<tx_job> job;
+                {
+                    gr::thread::scoped_lock lock(d_mutex);
+                    if (!d_spare_jobs.empty()) {
+                        job = std::move(d_spare_jobs.back());
+                        d_spare_jobs.pop_back();
+                    }
+                }
+                if (!job)
+                    job = std::make_shared<tx_job>();
+                d_coder.init_frame(job->frame, d_modulation, psdu, psdu_len);
+                job->done = false;
+
+                gr::thread::scoped_lock lock(d_mutex);
+                d_jobs.push_back(job);
+                d_pending.push_back(std::move(job));
+                d_pending_cond.notify_one();
+                return;
+            }
+
+            tx_frame frame;
+            d_coder.init_frame(frame, d_modulation, psdu, psdu_len);
+
+            gr::thread::scoped_lock lock(d_mutex);
+            d_coder.scramble_psdu(frame);
+            d_frames.push_back(std::move(frame));
+        }
+
+        int tx_frame_encoder_impl::flush_carry (gr_complex *out, int noutput_items) {
+            int n = std::min(noutput_items, d_carry_len - d_carry_pos);
+            std::memcpy(out, d_carry + d_carry_pos, n * sizeof(gr_complex));
+            d_carry_pos += n;
+            if (d_carry_pos == d_carry_len)
+                d_carry_len = d_carry_pos = 0;
+            return n;
+        }
+
+        int tx_frame_encoder_impl::copy_prefix (tx_frame &frame, gr_complex *out,
+                                                int noutput_items) {
+            int o = 0;
+            while ((d_stage == PREAMBLE || d_stage == HEADER) && o < noutput_items) {
+                int n = std::min<int>(noutput_items - o, d_segment->chips.size() - d_chip_offset);
+                std::memcpy(out + o, &d_segment->chips[d_chip_offset], n * sizeof(gr_complex));
+                o += n;
+                d_chip_offset += n;
+
+                if (d_chip_offset == (int) d_segment->chips.size()) {
+                    q_phase end = d_segment->end_phase;
+                    d_chip_offset = 0;
+                    if (d_stage == PREAMBLE) {
+                        d_segment = &d_coder.prefix_cache.header(frame.modulation,
+                                                                 frame.psdu.size(), end);
+                        d_stage = HEADER;
+                    } else {
+                        d_segment = nullptr;
+                        d_mapper.set_phase(end);
+                        d_mapper.set_modulation(frame.modulation);
+                        d_stage = PSDU;
+                    }
+                }
+            }
+            return o;
+        }
+
+        int tx_frame_encoder_impl::work_serial (int noutput_items, gr_complex *out) {
+            int o = flush_carry(out, noutput_items);
+
+            while (o < noutput_items && !d_frames.empty()) {
+                tx_frame &frame = d_frames.front();
+
+                if (d_stage == FRAME_START) {
+                    const pmt::pmt_t len_key = pmt::mp("ppdu_len");
+                    const pmt::pmt_t val = pmt::from_long(frame.n_chips);
+                    const pmt::pmt_t srcid = pmt::mp(alias());
+                    add_item_tag(0, nitems_written(0) + o, len_key, val, srcid);
+
+                    // Preamble and header are copied from the cache for
+                    // the phase the previous frame ended on
+                    d_segment = &d_coder.prefix_cache.preamble(d_mapper.phase());
+                    d_stage = PREAMBLE;
+                }
+                o += copy_prefix(frame, out + o, noutput_items - o);
+
+                int psdu_len = frame.psdu.size();
+                if (d_stage == PSDU && d_byte_offset < psdu_len && o < noutput_items) {
+                    // The whole bytes that fit in one call, then the byte
+                    // straddling the end of the output through the carry
+                    int n = std::min(psdu_len - d_byte_offset,
+                                     (noutput_items - o) / d_mapper.chips_per_byte());
+                    o += d_mapper.map(frame.psdu.data() + d_byte_offset, n, out + o);
+                    d_byte_offset += n;
+                    if (o < noutput_items && d_byte_offset < psdu_len) {
+                        d_carry_len = d_mapper.map_byte(frame.psdu[d_byte_offset++], d_carry);
+                        o += flush_carry(out + o, noutput_items - o);
+                    }
+                }
+
+                if (d_stage == PSDU && d_byte_offset == psdu_len) {
+                    d_stage = FRAME_START;
+                    d_byte_offset = 0;
+                    d_frames.pop_front();
+                    d_queued--;
+                }
+            }
+
+            return o;
+        }
+
+        int tx_frame_encoder_impl::work_parallel (int noutput_items, gr_complex *out,
+                                                  gr::thread::scoped_lock &lock) {
+            int o = 0;
+            while (o < noutput_items && !d_jobs.empty()) {
+                tx_job &job = *d_jobs.front();
+                // Only wait for a worker when there is nothing to return yet
+                if (!job.done) {
+                    if (o > 0) break;
+                    while (!job.done && !d_stopping)
+                        d_done_cond.wait(lock);
+                    if (!job.done) break;
+                }
+
+                if (d_chip_offset == 0) {
+                    const pmt::pmt_t len_key = pmt::mp("ppdu_len");
+                    const pmt::pmt_t val = pmt::from_long(job.frame.n_chips);
+                    const pmt::pmt_t srcid = pmt::mp(alias());
+                    add_item_tag(0, nitems_written(0) + o, len_key, val, srcid);
+                }
+
+                int n = std::min(noutput_items - o, job.frame.n_chips - d_chip_offset);
+                rotate_chips(&job.chips[d_chip_offset], out + o, n, d_mapper.phase());
+                o += n;
+                d_chip_offset += n;
+
+                if (d_chip_offset == job.frame.n_chips) {
+                    d_chip_offset = 0;
+                    d_mapper.set_phase(d_mapper.phase() + job.end_phase);
+                    d_spare_jobs.push_back(std::move(d_jobs.front()));
+                    d_jobs.pop_front();
+                    d_queued--;
+                }
+            }
+            return o;
+        }
+
+        int
+        tx_frame_encoder_impl::general_work (int noutput_items,
+                                             gr_vector_int &ninput_items,
+                                             gr_vector_const_void_star &input_items,
+                                             gr_vector_void_star &output_items)
+        {
+            gr::thread::scoped_lock lock(d_mutex);
+
+            gr_complex *out = (gr_complex *) output_items[0];
+            if (d_n_threads)
+                return work_parallel(noutput_items, out, lock);
+            return work_serial(noutput_items, out);
+        }
+
+    } /* namespace ieee802_11_b */
+} /* namespace gr */
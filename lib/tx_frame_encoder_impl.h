@@ -0,0 +1,126 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2019 gr-ieee802_11_b author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_IEEE802_11_B_TX_FRAME_ENCODER_IMPL_H
+#define INCLUDED_IEEE802_11_B_TX_FRAME_ENCODER_IMPL_H
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <ieee802_11_b/tx_frame_encoder.h>
+#include "chip_mapper.h"
+#include "frame_coder.h"
+
+/*
+ * A frame handed to the worker threads. Workers spread it from phase 0;
+ * since the chips of every modulation rotate with the phase a frame
+ * starts on, general_work rotates them onto the running phase.
+ */
+struct tx_job {
+    tx_frame frame;
+    std::vector<gr_complex> chips;
+    // Phase after the last chip, relative to the start of the frame
+    q_phase end_phase;
+    bool done;
+};
+
+namespace gr {
+    namespace ieee802_11_b {
+
+        class tx_frame_encoder_impl : public tx_frame_encoder
+        {
+        public:
+            tx_frame_encoder_impl(Modulation m, bool short_sync, int queue_depth,
+                                  int n_threads);
+            ~tx_frame_encoder_impl();
+
+            // Where all the action really happens
+            int general_work(int noutput_items,
+                             gr_vector_int &ninput_items,
+                             gr_vector_const_void_star &input_items,
+                             gr_vector_void_star &output_items);
+
+            void psdu_in(pmt::pmt_t msg);
+
+            bool start();
+            bool stop();
+
+            int queue_depth() const { return d_queue_depth; }
+            uint64_t frames_dropped() const { return d_frames_dropped; }
+            uint64_t frames_received() const { return d_frames_received; }
+            int queue_space() const { return d_queue_depth - d_queued; }
+
+        private:
+            Modulation d_modulation;
+            bool d_short_sync;
+            int d_n_threads;
+            int d_queue_depth;
+            chip_mapper d_mapper;
+            // Used by psdu_in and, for the prefix chips, general_work
+            frame_coder d_coder;
+
+            std::deque<tx_frame> d_frames;
+            // Progress through the front frame: the cached segment being
+            // copied and the next chip of it, then the next PSDU byte
+            enum {FRAME_START, PREAMBLE, HEADER, PSDU} d_stage;
+            const ppdu_prefix_cache::segment *d_segment;
+            int d_chip_offset;
+            int d_byte_offset;
+            gr::thread::mutex d_mutex;
+
+            // Chips of the last byte that did not fit in the output buffer
+            gr_complex d_carry[MAX_CHIPS_PER_BYTE];
+            int d_carry_len;
+            int d_carry_pos;
+
+            // With worker threads: frames in output order, the ones no
+            // worker has taken yet, and finished jobs kept for reuse
+            std::deque< std::shared_ptr<tx_job> > d_jobs;
+            std::deque< std::shared_ptr<tx_job> > d_pending;
+            std::vector< std::shared_ptr<tx_job> > d_spare_jobs;
+            gr::thread::condition_variable d_pending_cond;
+            gr::thread::condition_variable d_done_cond;
+            gr::thread::thread_group d_workers;
+            bool d_stopping;
+            // Frames accepted by psdu_in and not completely sent yet
+            std::atomic<int> d_queued;
+            std::atomic<uint64_t> d_frames_dropped;
+            std::atomic<uint64_t> d_frames_received;
+
+            int flush_carry (gr_complex *out, int noutput_items);
+
+            int copy_prefix (tx_frame &frame, gr_complex *out, int noutput_items);
+
+            int work_serial (int noutput_items, gr_complex *out);
+
+            int work_parallel (int noutput_items, gr_complex *out,
+                               gr::thread::scoped_lock &lock);
+
+            void worker ();
+        };
+
+    } // namespace ieee802_11_b
+} // namespace gr
+
+#endif /* INCLUDED_IEEE802_11_B_TX_FRAME_ENCODER_IMPL_H */
@@ -0,0 +1,132 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2019 gr-ieee802_11_b author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "work_stats.h"
+
+namespace gr {
+    namespace ieee802_11_b {
+
+        // Single writer: a plain load and store, no locked instruction
+        static inline void add(std::atomic<uint64_t> &counter, uint64_t n) {
+            counter.store(counter.load(std::memory_order_relaxed) + n,
+                          std::memory_order_relaxed);
+        }
+
+        work_stats::work_stats()
+            : d_enabled(false),
+              d_interval_ns(0),
+              d_next_report_ns(0),
+              d_reset_pending(false)
+        {
+            clear();
+        }
+
+        void work_stats::set_enabled(bool enabled) {
+            if (enabled && !d_enabled)
+                reset();
+            d_enabled = enabled;
+        }
+
+        void work_stats::set_interval(double seconds) {
+            d_interval_ns = seconds > 0 ? (int64_t) (seconds * 1e9) : 0;
+        }
+
+        void work_stats::clear() {
+            d_calls = 0;
+            d_items_in = 0;
+            d_items_out = 0;
+            d_ticks = 0;
+            d_queue_depth = 0;
+            d_queue_depth_max = 0;
+            for (auto &bucket : d_hist)
+                bucket = 0;
+            d_start_ticks = ticks();
+            d_start_ns = now_ns();
+            d_next_report_ns = d_start_ns + d_interval_ns;
+        }
+
+        bool work_stats::record(uint64_t ticks, uint64_t items_in, uint64_t items_out,
+                                uint64_t queue_depth) {
+            // Only this thread writes the counters, so a reset has to wait
+            // for it rather than race with add()
+            if (d_reset_pending.load(std::memory_order_acquire)) {
+                clear();
+                d_reset_pending.store(false, std::memory_order_release);
+            }
+
+            add(d_calls, 1);
+            add(d_items_in, items_in);
+            add(d_items_out, items_out);
+            add(d_ticks, ticks);
+            d_queue_depth.store(queue_depth, std::memory_order_relaxed);
+            if (queue_depth > d_queue_depth_max.load(std::memory_order_relaxed))
+                d_queue_depth_max.store(queue_depth, std::memory_order_relaxed);
+
+            int bucket = ticks ? 63 - __builtin_clzll(ticks) : 0;
+            add(d_hist[bucket < N_BUCKETS ? bucket : N_BUCKETS - 1], 1);
+
+            int64_t interval = d_interval_ns.load(std::memory_order_relaxed);
+            if (!interval)
+                return false;
+            int64_t now = now_ns();
+            if (now < d_next_report_ns)
+                return false;
+            d_next_report_ns = now + interval;
+            return true;
+        }
+
+        pmt::pmt_t work_stats::to_pmt() const {
+            // Until the work thread applies a reset, report what it will leave
+            const bool pending = d_reset_pending.load(std::memory_order_acquire);
+            auto read = [pending](const std::atomic<uint64_t> &counter) -> uint64_t {
+                return pending ? 0 : counter.load(std::memory_order_relaxed);
+            };
+
+            uint64_t calls = read(d_calls), items_out = read(d_items_out), ticks_spent = read(d_ticks);
+            double elapsed_s = (now_ns() - d_start_ns) * 1e-9;
+            double tick_hz = elapsed_s > 0 && !pending ? (ticks() - d_start_ticks) / elapsed_s : 0;
+
+            uint64_t hist[N_BUCKETS];
+            for (int i = 0; i < N_BUCKETS; ++i)
+                hist[i] = read(d_hist[i]);
+
+            pmt::pmt_t dict = pmt::make_dict();
+            dict = pmt::dict_add(dict, pmt::mp("work_calls"), pmt::from_uint64(calls));
+            dict = pmt::dict_add(dict, pmt::mp("items_in"), pmt::from_uint64(read(d_items_in)));
+            dict = pmt::dict_add(dict, pmt::mp("items_out"), pmt::from_uint64(items_out));
+            dict = pmt::dict_add(dict, pmt::mp("ticks"), pmt::from_uint64(ticks_spent));
+            dict = pmt::dict_add(dict, pmt::mp("ticks_per_item"),
+                                 pmt::from_double(items_out ? (double) ticks_spent / items_out : 0));
+            dict = pmt::dict_add(dict, pmt::mp("tick_hz"), pmt::from_double(tick_hz));
+            dict = pmt::dict_add(dict, pmt::mp("queue_depth"), pmt::from_uint64(read(d_queue_depth)));
+            dict = pmt::dict_add(dict, pmt::mp("queue_depth_max"),
+                                 pmt::from_uint64(read(d_queue_depth_max)));
+            // Bucket i counts the calls that took [2^i, 2^(i+1)) ticks
+            dict = pmt::dict_add(dict, pmt::mp("ticks_per_call_log2_hist"),
+                                 pmt::init_u64vector(N_BUCKETS, hist));
+            return dict;
+        }
+
+    } /* namespace ieee802_11_b */
+} /* namespace gr */
@@ -0,0 +1,120 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2019 gr-ieee802_11_b author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_IEEE802_11_B_WORK_STATS_H
+#define INCLUDED_IEEE802_11_B_WORK_STATS_H
+
+#include <pmt/pmt.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace gr {
+    namespace ieee802_11_b {
+
+        /*
+         * Hot-path counters of a block's work function: calls, items in
+         * and out, ticks spent (TSC cycles on x86, nanoseconds elsewhere),
+         * a histogram of ticks per call in power-of-two buckets and the
+         * depth of the block's internal queue. Only the thread running
+         * work writes them and any thread may read them; while disabled a
+         * work call costs two branches.
+         */
+        class work_stats
+        {
+        public:
+            static const int N_BUCKETS = 48;
+
+            work_stats();
+
+            void set_enabled(bool enabled);
+            bool enabled() const { return d_enabled.load(std::memory_order_relaxed); }
+
+            // Seconds between reports on the stats port, 0 for none
+            void set_interval(double seconds);
+
+            // Call at the start of work; 0 while disabled
+            uint64_t begin() const { return enabled() ? ticks() : 0; }
+
+            // Call at the end of work with what begin returned; true when
+            // a report is due
+            bool end(uint64_t start, uint64_t items_in, uint64_t items_out,
+                     uint64_t queue_depth) {
+                return start ? record(ticks() - start, items_in, items_out, queue_depth) : false;
+            }
+
+            // Zeroes the counters and restarts the report interval. Any
+            // thread may call it; the thread running work applies it at its
+            // next call, and until then the counters read as zero.
+            void reset() { d_reset_pending.store(true, std::memory_order_release); }
+
+            // Dictionary of all counters, as posted on the stats port
+            pmt::pmt_t to_pmt() const;
+
+            static uint64_t ticks() {
+#if defined(__x86_64__) || defined(__i386__)
+                return __rdtsc();
+#else
+                return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+            }
+
+        private:
+            typedef std::chrono::steady_clock clock;
+
+            std::atomic<bool> d_enabled;
+            std::atomic<int64_t> d_interval_ns;
+            // Only touched by the thread running work
+            int64_t d_next_report_ns;
+            std::atomic<bool> d_reset_pending;
+
+            std::atomic<uint64_t> d_calls;
+            std::atomic<uint64_t> d_items_in;
+            std::atomic<uint64_t> d_items_out;
+            std::atomic<uint64_t> d_ticks;
+            std::atomic<uint64_t> d_queue_depth;
+            std::atomic<uint64_t> d_queue_depth_max;
+            std::atomic<uint64_t> d_hist[N_BUCKETS];
+
+            // Relate ticks to time since the last reset
+            std::atomic<uint64_t> d_start_ticks;
+            std::atomic<int64_t> d_start_ns;
+
+            static int64_t now_ns() {
+                return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    clock::now().time_since_epoch()).count();
+            }
+
+            void clear();
+
+            bool record(uint64_t ticks, uint64_t items_in, uint64_t items_out,
+                        uint64_t queue_depth);
+        };
+
+    } // namespace ieee802_11_b
+} // namespace gr
+
+#endif /* INCLUDED_IEEE802_11_B_WORK_STATS_H */
@@ -0,0 +1,107 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+#
+# Copyright 2019 gr-ieee802_11_b author.
+#
+# This is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3, or (at your option)
+# any later version.
+#
+# This software is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this software; see the file COPYING.  If not, write to
+# the Free Software Foundation, Inc., 51 Franklin Street,
+# Boston, MA 02110-1301, USA.
+#
+
+from gnuradio import gr, gr_unittest
+from gnuradio import blocks
+import pmt
+import random
+import ieee802_11_b_swig as ieee802_11_b
+
+class qa_barker_despreader(gr_unittest.TestCase):
+
+    def setUp(self):
+        self.tb = gr.top_block()
+
+    def tearDown(self):
+        self.tb = None
+
+    def _round_trip(self, modulation, src_data):
+        tag = gr.tag_t()
+        tag.offset = 0
+        tag.key = pmt.intern("mod_change")
+        tag.value = pmt.from_long(modulation)
+
+        # The matched filter looks BARKER_LEN - 1 chips past the last
+        # symbol, so one padding byte is spread but not checked.
+        src_blk = blocks.vector_source_b(src_data + [0x00], False, 1, [tag])
+        mapper_blk = ieee802_11_b.code_mapper()
+        despreader_blk = ieee802_11_b.barker_despreader(modulation)
+        dst_blk = blocks.vector_sink_b()
+
+        self.tb.connect(src_blk, mapper_blk)
+        self.tb.connect(mapper_blk, despreader_blk)
+        self.tb.connect(despreader_blk, dst_blk)
+
+        self.tb.run()
+
+        self.assertEqual(tuple(src_data), dst_blk.data()[:len(src_data)])
+
+    def test_001_dbpsk(self):
+        self._round_trip(0, [random.randint(0, 255) for _ in range(200)])
+
+    def test_002_dqpsk(self):
+        self._round_trip(1, [random.randint(0, 255) for _ in range(200)])
+
+    def test_003_cck_rejected(self):
+        self.assertRaises(RuntimeError, ieee802_11_b.barker_despreader, 2)
+
+    def _offset_and_slip(self, modulation, offset, slip):
+        src_data = [random.randint(0, 255) for _ in range(200)]
+        tag = gr.tag_t()
+        tag.offset = 0
+        tag.key = pmt.intern("mod_change")
+        tag.value = pmt.from_long(modulation)
+
+        src_blk = blocks.vector_source_b(src_data, False, 1, [tag])
+        mapper_blk = ieee802_11_b.code_mapper()
+        chips_blk = blocks.vector_sink_c()
+        tb = gr.top_block()
+        tb.connect(src_blk, mapper_blk, chips_blk)
+        tb.run()
+
+        # Start off the symbol grid, then gain or lose chips halfway
+        chips = list(chips_blk.data())
+        cut = len(chips) // 2 + 4
+        if slip > 0:
+            chips = chips[:cut] + [0j] * slip + chips[cut:]
+        else:
+            chips = chips[:cut] + chips[cut - slip:]
+        chips = [0j] * offset + chips + [0j] * 30
+
+        tb = gr.top_block()
+        chip_src_blk = blocks.vector_source_c(chips)
+        despreader_blk = ieee802_11_b.barker_despreader(modulation)
+        dst_blk = blocks.vector_sink_b()
+        tb.connect(chip_src_blk, despreader_blk, dst_blk)
+        tb.run()
+
+        # Symbols around the slip are lost while the timing moves, but
+        # none may be decoded twice or skipped
+        self.assertEqual(tuple(src_data[150:190]), dst_blk.data()[150:190])
+
+    def test_004_timing_slip(self):
+        for modulation in (0, 1):
+            for offset, slip in ((3, 3), (5, 5), (3, -4), (0, -2)):
+                self._offset_and_slip(modulation, offset, slip)
+
+
+if __name__ == '__main__':
+    gr_unittest.run(qa_barker_despreader)
@@ -0,0 +1,119 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+#
+# Copyright 2019 gr-ieee802_11_b author.
+#
+# This is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3, or (at your option)
+# any later version.
+#
+# This software is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this software; see the file COPYING.  If not, write to
+# the Free Software Foundation, Inc., 51 Franklin Street,
+# Boston, MA 02110-1301, USA.
+#
+
+from gnuradio import gr, gr_unittest
+from gnuradio import blocks
+import pmt
+import random
+import ieee802_11_b_swig as ieee802_11_b
+
+class qa_cck_demapper(gr_unittest.TestCase):
+
+    def setUp(self):
+        self.tb = gr.top_block()
+
+    def tearDown(self):
+        self.tb = None
+
+    def _round_trip(self, modulation, src_data):
+        tag = gr.tag_t()
+        tag.offset = 0
+        tag.key = pmt.intern("mod_change")
+        tag.value = pmt.from_long(modulation)
+
+        src_blk = blocks.vector_source_b(src_data, False, 1, [tag])
+        mapper_blk = ieee802_11_b.code_mapper()
+        demapper_blk = ieee802_11_b.cck_demapper(modulation)
+        dst_blk = blocks.vector_sink_b()
+
+        self.tb.connect(src_blk, mapper_blk)
+        self.tb.connect(mapper_blk, demapper_blk)
+        self.tb.connect(demapper_blk, dst_blk)
+
+        self.tb.run()
+
+        self.assertEqual(tuple(src_data), dst_blk.data())
+
+    def test_001_cck_5_5(self):
+        self._round_trip(2, [random.randint(0, 255) for _ in range(500)])
+
+    def test_002_cck_11(self):
+        self._round_trip(3, [random.randint(0, 255) for _ in range(500)])
+
+    def test_003_barker_rejected(self):
+        self.assertRaises(RuntimeError, ieee802_11_b.cck_demapper, 1)
+
+    def _mod_tag(self, offset, modulation):
+        tag = gr.tag_t()
+        tag.offset = offset
+        tag.key = pmt.intern("mod_change")
+        tag.value = pmt.from_long(modulation)
+        return tag
+
+    def _after_header(self, modulation, use_tag):
+        # A DQPSK header leaving the phase at a quarter turn, then the PSDU
+        header = [0x0a, 0x15, 0x00, 0xe8]
+        psdu = [random.randint(0, 255) for _ in range(100)]
+        tags = [self._mod_tag(0, 1), self._mod_tag(len(header), modulation)]
+
+        tb = gr.top_block()
+        src_blk = blocks.vector_source_b(header + psdu, False, 1, tags)
+        mapper_blk = ieee802_11_b.code_mapper()
+        chips_blk = blocks.vector_sink_c()
+        tb.connect(src_blk, mapper_blk, chips_blk)
+        tb.run()
+        chips = chips_blk.data()
+        header_chips = 44 * len(header)
+
+        # The header despreader needs 10 chips past its last symbol
+        tb = gr.top_block()
+        chip_src_blk = blocks.vector_source_c(chips[:header_chips + 10])
+        despreader_blk = ieee802_11_b.barker_despreader(1)
+        header_sink = blocks.vector_sink_b()
+        tb.connect(chip_src_blk, despreader_blk, header_sink)
+        tb.run()
+        self.assertEqual(tuple(header), header_sink.data())
+        ref = despreader_blk.reference_phase()
+        self.assertNotEqual(0, ref)
+
+        demapper_blk = ieee802_11_b.cck_demapper(modulation)
+        psdu_tags = []
+        if use_tag:
+            tag = gr.tag_t()
+            tag.offset = 0
+            tag.key = pmt.intern("ref_phase")
+            tag.value = pmt.from_long(ref)
+            psdu_tags.append(tag)
+        else:
+            demapper_blk.set_reference_phase(ref)
+        dst_blk = blocks.vector_sink_b()
+        src_blk = blocks.vector_source_c(chips[header_chips:], False, 1, psdu_tags)
+        self.tb.connect(src_blk, demapper_blk, dst_blk)
+        self.tb.run()
+        self.assertEqual(tuple(psdu), dst_blk.data())
+
+    def test_004_nonzero_start_phase(self):
+        self._after_header(2, False)
+        self._after_header(3, True)
+
+
+if __name__ == '__main__':
+    gr_unittest.run(qa_cck_demapper)
@@ -21,6 +21,7 @@
 
 from gnuradio import gr, gr_unittest
 from gnuradio import blocks
+import pmt
 import ieee802_11_b_swig as ieee802_11_b
 
 class qa_code_mapper(gr_unittest.TestCase):
@@ -36,6 +37,81 @@ class qa_code_mapper(gr_unittest.TestCase):
         self.tb.run()
         # check data
 
+    def test_002_dbpsk_barker(self):
+        # Default modulation is DBPSK_1: a zero byte is eight unrotated
+        # Barker sequences.
+        barker = (1, -1, 1, 1, -1, 1, 1, 1, -1, -1, -1)
+        expected_res = barker * 8
+
+        src_blk = blocks.vector_source_b((0x00,))
+        mapper_blk = ieee802_11_b.code_mapper()
+        dst_blk = blocks.vector_sink_c()
+
+        self.tb.connect(src_blk, mapper_blk)
+        self.tb.connect(mapper_blk, dst_blk)
+
+        self.tb.run()
+
+        self.assertComplexTuplesAlmostEqual(expected_res, dst_blk.data())
+
+    def test_003_dbpsk_sc16(self):
+        # CHIPS_SC16 emits interleaved I/Q shorts scaled to amplitude * 32767
+        barker = (1, -1, 1, 1, -1, 1, 1, 1, -1, -1, -1)
+        expected_res = sum(((16384 * b, 0) for b in barker * 8), ())
+
+        src_blk = blocks.vector_source_b((0x00,))
+        mapper_blk = ieee802_11_b.code_mapper(ieee802_11_b.CHIPS_SC16, 0.5)
+        split_blk = blocks.vector_to_stream(gr.sizeof_short, 2)
+        dst_blk = blocks.vector_sink_s()
+
+        self.tb.connect(src_blk, mapper_blk)
+        self.tb.connect(mapper_blk, split_blk)
+        self.tb.connect(split_blk, dst_blk)
+
+        self.tb.run()
+
+        self.assertEqual(expected_res, dst_blk.data())
+
+    def test_004_latency_tracing(self):
+        psdu = [0x3C] * 20
+        n_frames = 3
+        # Long preamble and header, all at 1 Mbps: 88 chips per byte
+        ppdu_chips = (18 + 6 + len(psdu)) * 88
+
+        mapper_blk = ieee802_11_b.psdu_mapper(0, False)
+        scramble_blk = ieee802_11_b.scramble(False)
+        code_blk = ieee802_11_b.code_mapper()
+        head_blk = blocks.head(gr.sizeof_gr_complex, n_frames * ppdu_chips)
+        dst_blk = blocks.vector_sink_c()
+        msg_blk = blocks.message_debug()
+
+        self.tb.connect(mapper_blk, scramble_blk, code_blk, head_blk, dst_blk)
+        self.tb.msg_connect(code_blk, "latency", msg_blk, "store")
+
+        mapper_blk.set_latency_tracing(True)
+        blob = pmt.init_u8vector(len(psdu), psdu)
+        for _ in range(n_frames):
+            mapper_blk.to_basic_block()._post(pmt.intern("psdu in"), blob)
+        self.tb.run()
+
+        time_tags = [t for t in dst_blk.tags()
+                     if pmt.symbol_to_string(t.key) == "ppdu_time"]
+        self.assertEqual([i * ppdu_chips for i in range(n_frames)],
+                         [t.offset for t in time_tags])
+
+        self.assertEqual(n_frames, msg_blk.num_messages())
+        for i in range(n_frames):
+            record = msg_blk.get_message(i)
+            offset = pmt.to_uint64(pmt.dict_ref(record, pmt.intern("offset"), pmt.PMT_NIL))
+            self.assertEqual(i * ppdu_chips, offset)
+
+        summary = code_blk.latency_summary()
+        count = pmt.to_uint64(pmt.dict_ref(summary, pmt.intern("count"), pmt.PMT_NIL))
+        p50 = pmt.to_uint64(pmt.dict_ref(summary, pmt.intern("p50_ns"), pmt.PMT_NIL))
+        max_ns = pmt.to_uint64(pmt.dict_ref(summary, pmt.intern("max_ns"), pmt.PMT_NIL))
+        self.assertEqual(n_frames, count)
+        self.assertLessEqual(p50, max_ns)
+
 
 if __name__ == '__main__':
     gr_unittest.run(qa_code_mapper)
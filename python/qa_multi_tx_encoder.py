@@ -0,0 +1,144 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+#
+# Copyright 2019 gr-ieee802_11_b author.
+#
+# This is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3, or (at your option)
+# any later version.
+#
+# This software is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this software; see the file COPYING.  If not, write to
+# the Free Software Foundation, Inc., 51 Franklin Street,
+# Boston, MA 02110-1301, USA.
+#
+
+from gnuradio import gr, gr_unittest
+from gnuradio import blocks
+import pmt
+import ieee802_11_b_swig as ieee802_11_b
+
+def post_psdu(blk, channel, psdu):
+    blob = pmt.init_u8vector(len(psdu), psdu)
+    blk.to_basic_block()._post(pmt.intern("psdu in"),
+                               pmt.cons(pmt.from_long(channel), blob))
+
+class qa_multi_tx_encoder(gr_unittest.TestCase):
+
+    def setUp(self):
+        self.tb = gr.top_block()
+
+    def tearDown(self):
+        self.tb = None
+
+    def reference_chips(self, psdus):
+        # The same frames through a single-channel encoder
+        n_chips = sum(24 * 88 + len(p) * 8 for p in psdus)
+        tb = gr.top_block()
+        encoder_blk = ieee802_11_b.tx_frame_encoder(3, False)
+        head_blk = blocks.head(gr.sizeof_gr_complex, n_chips)
+        dst_blk = blocks.vector_sink_c()
+        tb.connect(encoder_blk, head_blk, dst_blk)
+        for psdu in psdus:
+            blob = pmt.init_u8vector(len(psdu), psdu)
+            encoder_blk.to_basic_block()._post(pmt.intern("psdu in"),
+                                               pmt.cons(pmt.PMT_NIL, blob))
+        tb.run()
+        return dst_blk.data()
+
+    def test_001_channels_match_tx_frame_encoder(self):
+        psdus = [[[(c * 53 + i * 7 + k) & 0xFF for k in range(20 + 10 * i)]
+                  for i in range(3 - c)] for c in range(3)]
+        refs = [self.reference_chips(p) for p in psdus]
+        n_chips = len(refs[0])
+
+        encoder_blk = ieee802_11_b.multi_tx_encoder(3, False, 4)
+        sinks = []
+        for c in range(4):
+            head_blk = blocks.head(gr.sizeof_gr_complex, n_chips)
+            dst_blk = blocks.vector_sink_c()
+            self.tb.connect((encoder_blk, c), head_blk, dst_blk)
+            sinks.append(dst_blk)
+        for c in range(3):
+            for psdu in psdus[c]:
+                post_psdu(encoder_blk, c, psdu)
+        self.tb.run()
+
+        for c in range(3):
+            data = sinks[c].data()
+            tags = sinks[c].tags()
+            self.assertEqual(len(psdus[c]), len(tags))
+            # Frames of a channel follow each other without a gap
+            start = tags[0].offset
+            self.assertEqual(0, start % 8)
+            self.assertComplexTuplesAlmostEqual(refs[c], data[start:start + len(refs[c])])
+            for t in tags:
+                self.assertEqual(0, t.offset % 8)
+        # A channel without frames sends zeros
+        self.assertEqual(0, len(sinks[3].tags()))
+        self.assertEqual((0j,) * n_chips, tuple(sinks[3].data()))
+
+    def test_002_interleaved(self):
+        psdus = [[(c * 31 + k) & 0xFF for k in range(40)] for c in range(3)]
+        n_chips = 24 * 88 + 40 * 8
+
+        streams_blk = ieee802_11_b.multi_tx_encoder(3, False, 3)
+        stream_sinks = []
+        for c in range(3):
+            head_blk = blocks.head(gr.sizeof_gr_complex, n_chips)
+            dst_blk = blocks.vector_sink_c()
+            self.tb.connect((streams_blk, c), head_blk, dst_blk)
+            stream_sinks.append(dst_blk)
+
+        interleaved_blk = ieee802_11_b.multi_tx_encoder(3, False, 3, True)
+        head_blk = blocks.head(gr.sizeof_gr_complex, 3 * n_chips)
+        dst_blk = blocks.vector_sink_c()
+        self.tb.connect(interleaved_blk, head_blk, dst_blk)
+
+        for c in range(3):
+            post_psdu(streams_blk, c, psdus[c])
+            post_psdu(interleaved_blk, c, psdus[c])
+        self.tb.run()
+
+        data = dst_blk.data()
+        for c in range(3):
+            chips = data[c::3]
+            tags = [t for t in dst_blk.tags() if t.offset % 3 == c]
+            self.assertEqual(1, len(tags))
+            start = tags[0].offset // 3
+            ref = stream_sinks[c].data()
+            ref_start = stream_sinks[c].tags()[0].offset
+            n = min(len(chips) - start, len(ref) - ref_start)
+            self.assertComplexTuplesAlmostEqual(ref[ref_start:ref_start + n],
+                                                chips[start:start + n])
+
+    def test_003_invalid_channel(self):
+        encoder_blk = ieee802_11_b.multi_tx_encoder(3, False, 2)
+        sinks = []
+        for c in range(2):
+            head_blk = blocks.head(gr.sizeof_gr_complex, 24 * 88 + 8)
+            dst_blk = blocks.vector_sink_c()
+            self.tb.connect((encoder_blk, c), head_blk, dst_blk)
+            sinks.append(dst_blk)
+
+        post_psdu(encoder_blk, 2, [1])
+        post_psdu(encoder_blk, -1, [1])
+        encoder_blk.to_basic_block()._post(pmt.intern("psdu in"),
+                                           pmt.cons(pmt.PMT_NIL, pmt.init_u8vector(1, [1])))
+        post_psdu(encoder_blk, 1, [1] * 4096)
+        post_psdu(encoder_blk, 0, [1])
+        self.tb.run()
+
+        self.assertEqual(4, encoder_blk.frames_dropped())
+        self.assertEqual(1, len(sinks[0].tags()))
+        self.assertEqual(0, len(sinks[1].tags()))
+
+
+if __name__ == '__main__':
+    gr_unittest.run(qa_multi_tx_encoder)
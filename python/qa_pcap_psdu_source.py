@@ -0,0 +1,121 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+#
+# Copyright 2019 gr-ieee802_11_b author.
+#
+# This is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3, or (at your option)
+# any later version.
+#
+# This software is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this software; see the file COPYING.  If not, write to
+# the Free Software Foundation, Inc., 51 Franklin Street,
+# Boston, MA 02110-1301, USA.
+#
+
+from gnuradio import gr, gr_unittest
+from gnuradio import blocks
+import os
+import struct
+import tempfile
+import time
+import ieee802_11_b_swig as ieee802_11_b
+
+class qa_pcap_psdu_source(gr_unittest.TestCase):
+
+    def setUp(self):
+        self.tb = gr.top_block()
+        fd, self.path = tempfile.mkstemp(suffix='.pcap')
+        os.close(fd)
+
+    def tearDown(self):
+        self.tb = None
+        os.remove(self.path)
+
+    def write_pcap(self, records, linktype):
+        with open(self.path, 'wb') as f:
+            f.write(struct.pack('<IHHiIII', 0xa1b2c3d4, 2, 4, 0, 0, 65535, linktype))
+            for data, orig_len in records:
+                f.write(struct.pack('<IIII', 0, 0, len(data), orig_len))
+                f.write(data)
+
+    def run_until(self, dst_blk, n_items):
+        self.tb.start()
+        deadline = time.time() + 10
+        while len(dst_blk.data()) < n_items and time.time() < deadline:
+            time.sleep(0.01)
+        self.tb.stop()
+        self.tb.wait()
+        return dst_blk.data()[:n_items]
+
+    def test_001_radiotap_frames_to_psdu_mapper(self):
+        psdus = [bytes(bytearray((i * 7 + k) % 256 for k in range(10 + i)))
+                 for i in range(5)]
+        radiotap = b'\x00\x00\x08\x00\x00\x00\x00\x00'
+        records = [(radiotap + p, len(radiotap) + len(p)) for p in psdus]
+        # Cut short by the capture's snap length
+        records.insert(2, (radiotap + b'\x01\x02', 100))
+        self.write_pcap(records, 127)
+
+        src_blk = ieee802_11_b.pcap_psdu_source(self.path, True, 0, False)
+        mapper_blk = ieee802_11_b.psdu_mapper(0, False, 2)
+        dst_blk = blocks.vector_sink_b()
+        self.tb.msg_connect(src_blk, "psdu out", mapper_blk, "psdu in")
+        self.tb.connect(mapper_blk, dst_blk)
+
+        # 18 bytes of long preamble and 6 bytes of PLCP header per PSDU
+        data = self.run_until(dst_blk, len(psdus) * 24 + sum(len(p) for p in psdus))
+
+        pos = 0
+        for p in psdus:
+            pos += 24
+            self.assertEqual(tuple(bytearray(p)), data[pos:pos + len(p)])
+            pos += len(p)
+        self.assertEqual(len(psdus), src_blk.frames_sent())
+        self.assertEqual(1, src_blk.frames_skipped())
+        self.assertEqual(0, mapper_blk.frames_dropped())
+
+    def test_002_repeat_at_frame_rate(self):
+        psdu = b'\x5a' * 4
+        self.write_pcap([(psdu, len(psdu))], 105)
+
+        src_blk = ieee802_11_b.pcap_psdu_source(self.path, True, 200, True)
+        mapper_blk = ieee802_11_b.psdu_mapper(0, False)
+        dst_blk = blocks.vector_sink_b()
+        self.tb.msg_connect(src_blk, "psdu out", mapper_blk, "psdu in")
+        self.tb.connect(mapper_blk, dst_blk)
+
+        start = time.time()
+        data = self.run_until(dst_blk, 10 * (24 + len(psdu)))
+        # Ten frames at 200 per second take at least 45 ms
+        self.assertGreater(time.time() - start, 0.045)
+        for i in range(10):
+            pos = i * (24 + len(psdu)) + 24
+            self.assertEqual((0x5a,) * 4, data[pos:pos + 4])
+
+    def test_003_back_pressure_from_tx_frame_encoder(self):
+        psdus = [bytes(bytearray((i * 5 + k) % 256 for k in range(8))) for i in range(20)]
+        self.write_pcap([(p, len(p)) for p in psdus], 105)
+
+        src_blk = ieee802_11_b.pcap_psdu_source(self.path, True, 0, False)
+        encoder_blk = ieee802_11_b.tx_frame_encoder(0, False, 2)
+        dst_blk = blocks.vector_sink_c()
+        self.tb.msg_connect(src_blk, "psdu out", encoder_blk, "psdu in")
+        self.tb.connect(encoder_blk, dst_blk)
+
+        # 11 chips per DBPSK bit of preamble, header and PSDU
+        self.run_until(dst_blk, len(psdus) * (24 + 8) * 88)
+
+        self.assertEqual(len(psdus), src_blk.frames_sent())
+        self.assertEqual(len(psdus), encoder_blk.frames_received())
+        self.assertEqual(0, encoder_blk.frames_dropped())
+
+
+if __name__ == '__main__':
+    gr_unittest.run(qa_pcap_psdu_source)
@@ -0,0 +1,101 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+#
+# Copyright 2019 gr-ieee802_11_b author.
+#
+# This is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3, or (at your option)
+# any later version.
+#
+# This software is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this software; see the file COPYING.  If not, write to
+# the Free Software Foundation, Inc., 51 Franklin Street,
+# Boston, MA 02110-1301, USA.
+#
+
+from gnuradio import gr, gr_unittest
+from gnuradio import blocks
+import pmt
+import ieee802_11_b_swig as ieee802_11_b
+
+class qa_phase_expander(gr_unittest.TestCase):
+
+    def setUp(self):
+        self.tb = gr.top_block()
+
+    def tearDown(self):
+        self.tb = None
+
+    def test_001_lookup(self):
+        # Phase index 0..3 of each chip, first chip in the low bits
+        src_blk = blocks.vector_source_b((0xE4, 0x1B))
+        expander_blk = ieee802_11_b.phase_expander()
+        dst_blk = blocks.vector_sink_c()
+
+        self.tb.connect(src_blk, expander_blk)
+        self.tb.connect(expander_blk, dst_blk)
+
+        self.tb.run()
+
+        self.assertComplexTuplesAlmostEqual((1, 1j, -1, -1j, -1j, -1, 1j, 1),
+                                            dst_blk.data())
+
+    def test_002_replay_packed_chips(self):
+        # Packed code_mapper output expanded again equals the direct chips
+        data = tuple(range(256))
+
+        src_blk = blocks.vector_source_b(data)
+        packed_blk = ieee802_11_b.code_mapper(ieee802_11_b.CHIPS_PHASE_PACKED)
+        expander_blk = ieee802_11_b.phase_expander(ieee802_11_b.CHIPS_FC32, 1.0)
+        mapper_blk = ieee802_11_b.code_mapper()
+        expanded_dst_blk = blocks.vector_sink_c()
+        direct_dst_blk = blocks.vector_sink_c()
+
+        self.tb.connect(src_blk, packed_blk, expander_blk, expanded_dst_blk)
+        self.tb.connect(src_blk, mapper_blk, direct_dst_blk)
+
+        self.tb.run()
+
+        self.assertEqual(len(data) * 88, len(direct_dst_blk.data()))
+        self.assertComplexTuplesAlmostEqual(direct_dst_blk.data(),
+                                            expanded_dst_blk.data())
+
+    def test_003_gap_expanded_to_zeros(self):
+        psdu = [0x5A] * 6
+        gap_len = 3
+        n_chips = 2 * ((18 + 6) * 88 + len(psdu) * 16 + gap_len * 16)
+
+        mapper_blk = ieee802_11_b.psdu_mapper(2, False, 64, 16, gap_len)
+        scramble_blk = ieee802_11_b.scramble(False)
+        packed_blk = ieee802_11_b.code_mapper(ieee802_11_b.CHIPS_PHASE_PACKED)
+        expander_blk = ieee802_11_b.phase_expander(ieee802_11_b.CHIPS_FC32, 1.0)
+        expanded_head_blk = blocks.head(gr.sizeof_gr_complex, n_chips)
+        expanded_dst_blk = blocks.vector_sink_c()
+        code_blk = ieee802_11_b.code_mapper()
+        direct_head_blk = blocks.head(gr.sizeof_gr_complex, n_chips)
+        direct_dst_blk = blocks.vector_sink_c()
+
+        self.tb.connect(mapper_blk, scramble_blk)
+        self.tb.connect(scramble_blk, packed_blk, expander_blk, expanded_head_blk,
+                        expanded_dst_blk)
+        self.tb.connect(scramble_blk, code_blk, direct_head_blk, direct_dst_blk)
+
+        blob = pmt.init_u8vector(len(psdu), psdu)
+        for _ in range(2):
+            mapper_blk.to_basic_block()._post(pmt.intern("psdu in"), blob)
+        self.tb.run()
+
+        self.assertEqual(n_chips, len(expanded_dst_blk.data()))
+        self.assertIn(0j, direct_dst_blk.data())
+        self.assertComplexTuplesAlmostEqual(direct_dst_blk.data(),
+                                            expanded_dst_blk.data())
+
+
+if __name__ == '__main__':
+    gr_unittest.run(qa_phase_expander)
@@ -0,0 +1,83 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+#
+# Copyright 2019 gr-ieee802_11_b author.
+#
+# This is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3, or (at your option)
+# any later version.
+#
+# This software is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this software; see the file COPYING.  If not, write to
+# the Free Software Foundation, Inc., 51 Franklin Street,
+# Boston, MA 02110-1301, USA.
+#
+
+from gnuradio import gr, gr_unittest
+from gnuradio import blocks
+import pmt
+import ieee802_11_b_swig as ieee802_11_b
+
+class qa_plcp_sync(gr_unittest.TestCase):
+
+    def setUp(self):
+        self.tb = gr.top_block()
+
+    def tearDown(self):
+        self.tb = None
+
+    def _receive(self, modulation, short_sync, psdu):
+        prefix_len = (9 if short_sync else 18) + 6
+
+        mapper_blk = ieee802_11_b.psdu_mapper(modulation, short_sync)
+        head_blk = blocks.head(gr.sizeof_char, prefix_len + len(psdu))
+        scramble_blk = ieee802_11_b.scramble(False)
+        descramble_blk = ieee802_11_b.scramble(True)
+        sync_blk = ieee802_11_b.plcp_sync()
+        dst_blk = blocks.vector_sink_b()
+        dbg_blk = blocks.message_debug()
+
+        self.tb.connect(mapper_blk, head_blk, scramble_blk, descramble_blk,
+                        sync_blk, dst_blk)
+        self.tb.msg_connect(sync_blk, "psdu out", dbg_blk, "store")
+
+        blob = pmt.init_u8vector(len(psdu), psdu)
+        mapper_blk.to_basic_block()._post(pmt.intern("psdu in"), blob)
+        self.tb.run()
+
+        self.assertEqual(1, dbg_blk.num_messages())
+        self.assertEqual(1, sync_blk.frames_received())
+        return dbg_blk.get_message(0), dst_blk
+
+    def test_001_long_sync(self):
+        psdu = list(range(50))
+        msg, dst_blk = self._receive(3, False, psdu)
+
+        meta = pmt.car(msg)
+        self.assertEqual(3, pmt.to_long(pmt.dict_ref(meta, pmt.intern("modulation"), pmt.PMT_NIL)))
+        self.assertFalse(pmt.to_bool(pmt.dict_ref(meta, pmt.intern("short_sync"), pmt.PMT_NIL)))
+        self.assertEqual(tuple(psdu), tuple(pmt.u8vector_elements(pmt.cdr(msg))))
+
+        # Header followed by the PSDU, with the PSDU's modulation tagged
+        self.assertEqual(tuple(psdu), dst_blk.data()[6:])
+        mod_tags = [(t.offset, pmt.to_long(t.value)) for t in dst_blk.tags()
+                    if pmt.symbol_to_string(t.key) == "mod_change"]
+        self.assertEqual([(0, 0), (6, 3)], mod_tags)
+
+    def test_002_short_sync(self):
+        psdu = [0x5A] * 17
+        msg, dst_blk = self._receive(2, True, psdu)
+
+        meta = pmt.car(msg)
+        self.assertTrue(pmt.to_bool(pmt.dict_ref(meta, pmt.intern("short_sync"), pmt.PMT_NIL)))
+        self.assertEqual(tuple(psdu), tuple(pmt.u8vector_elements(pmt.cdr(msg))))
+
+
+if __name__ == '__main__':
+    gr_unittest.run(qa_plcp_sync)
@@ -21,6 +21,7 @@
 
 from gnuradio import gr, gr_unittest
 from gnuradio import blocks
+import pmt
 import ieee802_11_b_swig as ieee802_11_b
 
 class qa_psdu_mapper(gr_unittest.TestCase):
@@ -36,6 +37,106 @@ class qa_psdu_mapper(gr_unittest.TestCase):
         self.tb.run()
         # check data
 
+    def test_002_long_sync_ppdu(self):
+        psdu = [0xAB] * 10
+        # 18 bytes of long preamble, 6 bytes of PLCP header, then the PSDU
+        ppdu_len = 18 + 6 + len(psdu)
+
+        mapper_blk = ieee802_11_b.psdu_mapper(0, False)
+        head_blk = blocks.head(gr.sizeof_char, ppdu_len)
+        dst_blk = blocks.vector_sink_b()
+
+        self.tb.connect(mapper_blk, head_blk)
+        self.tb.connect(head_blk, dst_blk)
+
+        blob = pmt.init_u8vector(len(psdu), psdu)
+        mapper_blk.to_basic_block()._post(pmt.intern("psdu in"), blob)
+        self.tb.run()
+
+        ppdu = dst_blk.data()
+        self.assertEqual(ppdu_len, len(ppdu))
+        self.assertEqual((0xFF,) * 16 + (0xA0, 0xF3), ppdu[:18])
+        # SIGNAL field for 1 Mbps
+        self.assertEqual(0x0A, ppdu[18])
+        self.assertEqual(tuple(psdu), ppdu[24:])
+
+    def test_003_batch_with_gap(self):
+        psdu = [0x55] * 4
+        gap_len = 3
+        ppdu_len = 18 + 6 + len(psdu)
+        n_frames = 3
+
+        mapper_blk = ieee802_11_b.psdu_mapper(3, False, 64, 16, gap_len)
+        head_blk = blocks.head(gr.sizeof_char, n_frames * (ppdu_len + gap_len))
+        dst_blk = blocks.vector_sink_b()
+
+        self.tb.connect(mapper_blk, head_blk)
+        self.tb.connect(head_blk, dst_blk)
+
+        blob = pmt.init_u8vector(len(psdu), psdu)
+        for _ in range(n_frames):
+            mapper_blk.to_basic_block()._post(pmt.intern("psdu in"), blob)
+        self.tb.run()
+
+        data = dst_blk.data()
+        len_tags = [t for t in dst_blk.tags()
+                    if pmt.symbol_to_string(t.key) == "ppdu_len"]
+        self.assertEqual([i * (ppdu_len + gap_len) for i in range(n_frames)],
+                         [t.offset for t in len_tags])
+        for i in range(n_frames):
+            gap_start = i * (ppdu_len + gap_len) + ppdu_len
+            self.assertEqual((0,) * gap_len, data[gap_start:gap_start + gap_len])
+
+    def test_004_oversized_psdu_dropped(self):
+        psdu = [0x11] * 10
+        ppdu_len = 18 + 6 + len(psdu)
+
+        mapper_blk = ieee802_11_b.psdu_mapper(0, False)
+        head_blk = blocks.head(gr.sizeof_char, ppdu_len)
+        dst_blk = blocks.vector_sink_b()
+        self.tb.connect(mapper_blk, head_blk, dst_blk)
+
+        too_long = pmt.init_u8vector(4096, [0x22] * 4096)
+        mapper_blk.to_basic_block()._post(pmt.intern("psdu in"), too_long)
+        blob = pmt.init_u8vector(len(psdu), psdu)
+        mapper_blk.to_basic_block()._post(pmt.intern("psdu in"), blob)
+        self.tb.run()
+
+        self.assertEqual(tuple(psdu), dst_blk.data()[24:])
+        self.assertEqual(1, mapper_blk.frames_dropped())
+
+    def test_005_gap_sent_as_silence(self):
+        psdu = [0x0F] * 4
+        gap_len = 2
+        n_frames = 2
+        # Preamble and header at 1 Mbps, PSDU and gap at 11 Mbps
+        ppdu_chips = (18 + 6) * 88 + len(psdu) * 8
+        frame_chips = ppdu_chips + gap_len * 8
+
+        mapper_blk = ieee802_11_b.psdu_mapper(3, False, 64, 16, gap_len)
+        scramble_blk = ieee802_11_b.scramble(False)
+        code_blk = ieee802_11_b.code_mapper()
+        head_blk = blocks.head(gr.sizeof_gr_complex, n_frames * frame_chips)
+        dst_blk = blocks.vector_sink_c()
+        self.tb.connect(mapper_blk, scramble_blk, code_blk, head_blk, dst_blk)
+
+        blob = pmt.init_u8vector(len(psdu), psdu)
+        for _ in range(n_frames):
+            mapper_blk.to_basic_block()._post(pmt.intern("psdu in"), blob)
+        self.tb.run()
+
+        chips = dst_blk.data()
+        for i in range(n_frames):
+            start = i * frame_chips
+            self.assertTrue(all(abs(abs(c) - 1) < 1e-6 for c in chips[start:start + ppdu_chips]))
+            self.assertEqual((0j,) * (gap_len * 8), chips[start + ppdu_chips:start + frame_chips])
+
+        gap_tags = [t for t in dst_blk.tags()
+                    if pmt.symbol_to_string(t.key) == "gap"]
+        self.assertEqual([i * frame_chips + ppdu_chips for i in range(n_frames)],
+                         [t.offset for t in gap_tags])
+        self.assertEqual([gap_len * 8] * n_frames, [pmt.to_long(t.value) for t in gap_tags])
+
 
 if __name__ == '__main__':
     gr_unittest.run(qa_psdu_mapper)
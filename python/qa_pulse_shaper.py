@@ -0,0 +1,67 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+#
+# Copyright 2019 gr-ieee802_11_b author.
+#
+# This is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3, or (at your option)
+# any later version.
+#
+# This software is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this software; see the file COPYING.  If not, write to
+# the Free Software Foundation, Inc., 51 Franklin Street,
+# Boston, MA 02110-1301, USA.
+#
+
+from gnuradio import gr, gr_unittest
+from gnuradio import blocks, filter
+from gnuradio.filter import firdes
+import ieee802_11_b_swig as ieee802_11_b
+
+class qa_pulse_shaper(gr_unittest.TestCase):
+
+    def setUp(self):
+        self.tb = gr.top_block()
+
+    def tearDown(self):
+        self.tb = None
+
+    def run_against_fir(self, sps, taps, data):
+        # Same chips through a generic interpolating FIR filter
+        src_blk = blocks.vector_source_b(data)
+        packed_blk = ieee802_11_b.code_mapper(ieee802_11_b.CHIPS_PHASE_PACKED)
+        shaper_blk = ieee802_11_b.pulse_shaper(sps, taps)
+        mapper_blk = ieee802_11_b.code_mapper()
+        fir_blk = filter.interp_fir_filter_ccf(sps, taps)
+        shaped_dst_blk = blocks.vector_sink_c()
+        fir_dst_blk = blocks.vector_sink_c()
+
+        self.tb.connect(src_blk, packed_blk, shaper_blk, shaped_dst_blk)
+        self.tb.connect(src_blk, mapper_blk, fir_blk, fir_dst_blk)
+
+        self.tb.run()
+
+        self.assertEqual(len(data) * 88 * sps, len(shaped_dst_blk.data()))
+        self.assertComplexTuplesAlmostEqual(fir_dst_blk.data(),
+                                            shaped_dst_blk.data(), 4)
+
+    def test_001_rrc_4x(self):
+        taps = firdes.root_raised_cosine(1, 4, 1, 0.35, 33)
+        self.run_against_fir(4, taps, tuple(range(64)))
+
+    def test_002_rrc_8x(self):
+        taps = firdes.root_raised_cosine(1, 8, 1, 0.35, 65)
+        self.run_against_fir(8, taps, tuple(range(64)))
+
+    def test_003_span_too_long(self):
+        self.assertRaises(RuntimeError, ieee802_11_b.pulse_shaper, 4, [1.0] * 129)
+
+
+if __name__ == '__main__':
+    gr_unittest.run(qa_pulse_shaper)
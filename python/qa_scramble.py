@@ -21,6 +21,7 @@
 
 from gnuradio import gr, gr_unittest
 from gnuradio import blocks
+import pmt
 import ieee802_11_b_swig as ieee802_11_b
 import random
 import time
@@ -71,6 +72,62 @@ class qa_scramble(gr_unittest.TestCase):
         self.assertEqual(expected_res[1], actual_res[1])
 
 
+    def test_005_bit_serial_reference(self):
+        src_data = [random.randint(0, 255) for _ in range(4096)]
+
+        for reverse in (False, True):
+            self.tb = gr.top_block()
+            src_blk = blocks.vector_source_b(src_data)
+            scramble_blk = ieee802_11_b.scramble(reverse)
+            dst_blk = blocks.vector_sink_b()
+
+            self.tb.connect(src_blk, scramble_blk)
+            self.tb.connect(scramble_blk, dst_blk)
+
+            self.tb.run()
+
+            expected_res = self._scramble_reference(src_data, reverse)
+            self.assertEqual(tuple(expected_res), dst_blk.data())
+
+    def test_006_work_stats(self):
+        src_data = [random.randint(0, 255) for _ in range(10000)]
+
+        src_blk = blocks.vector_source_b(src_data)
+        scramble_blk = ieee802_11_b.scramble(False)
+        dst_blk = blocks.vector_sink_b()
+        self.tb.connect(src_blk, scramble_blk)
+        self.tb.connect(scramble_blk, dst_blk)
+
+        scramble_blk.set_stats_enabled(True)
+        self.tb.run()
+
+        stats = scramble_blk.stats()
+        calls = pmt.to_uint64(pmt.dict_ref(stats, pmt.intern("work_calls"), pmt.PMT_NIL))
+        items_in = pmt.to_uint64(pmt.dict_ref(stats, pmt.intern("items_in"), pmt.PMT_NIL))
+        hist = pmt.u64vector_elements(
+            pmt.dict_ref(stats, pmt.intern("ticks_per_call_log2_hist"), pmt.PMT_NIL))
+        self.assertGreater(calls, 0)
+        self.assertEqual(len(src_data), items_in)
+        self.assertEqual(calls, sum(hist))
+
+        scramble_blk.reset_stats()
+        stats = scramble_blk.stats()
+        self.assertEqual(0, pmt.to_uint64(pmt.dict_ref(stats, pmt.intern("work_calls"), pmt.PMT_NIL)))
+
+    def _scramble_reference(self, data, reverse):
+        state = 0 if reverse else 0x1b
+        res = []
+        for byte in data:
+            out = 0
+            for b in range(8):
+                bit_in = (byte >> b) & 0x01
+                feedback = ((state >> 3) ^ (state >> 6)) & 0x01
+                bit_out = bit_in ^ feedback
+                state = ((state << 1) & 0x7F) | (bit_in if reverse else bit_out)
+                out |= bit_out << b
+            res.append(out)
+        return res
+
     def test_003_no_data(self):
         print("Time elapsed = " + str(self._test_timing(0)))
 
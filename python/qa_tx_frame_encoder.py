@@ -0,0 +1,187 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+#
+# Copyright 2019 gr-ieee802_11_b author.
+#
+# This is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3, or (at your option)
+# any later version.
+#
+# This software is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this software; see the file COPYING.  If not, write to
+# the Free Software Foundation, Inc., 51 Franklin Street,
+# Boston, MA 02110-1301, USA.
+#
+
+from gnuradio import gr, gr_unittest
+from gnuradio import blocks
+import pmt
+import ieee802_11_b_swig as ieee802_11_b
+
+class qa_tx_frame_encoder(gr_unittest.TestCase):
+
+    def setUp(self):
+        self.tb = gr.top_block()
+
+    def tearDown(self):
+        self.tb = None
+
+    def test_001_frame_length(self):
+        # CCK_11 with long sync: 24 DBPSK bytes of preamble and header
+        # (88 chips each) followed by 8 chips per PSDU byte.
+        psdu = list(range(100))
+        n_chips = 24 * 88 + len(psdu) * 8
+
+        encoder_blk = ieee802_11_b.tx_frame_encoder(3, False)
+        head_blk = blocks.head(gr.sizeof_gr_complex, n_chips)
+        dst_blk = blocks.vector_sink_c()
+
+        self.tb.connect(encoder_blk, head_blk)
+        self.tb.connect(head_blk, dst_blk)
+
+        blob = pmt.init_u8vector(len(psdu), psdu)
+        encoder_blk.to_basic_block()._post(pmt.intern("psdu in"),
+                                           pmt.cons(pmt.PMT_NIL, blob))
+        self.tb.run()
+
+        chips = dst_blk.data()
+        self.assertEqual(n_chips, len(chips))
+        for c in chips:
+            self.assertAlmostEqual(1.0, abs(c))
+
+        tags = dst_blk.tags()
+        self.assertEqual(1, len(tags))
+        self.assertEqual(0, tags[0].offset)
+        self.assertEqual(n_chips, pmt.to_long(tags[0].value))
+
+    def test_002_matches_block_chain(self):
+        # Frames of one length reuse the cached preamble and header chips
+        # from whatever phase the previous frame ended on
+        psdus = [[(i * 37 + k) & 0xFF for k in range(20)] for i in range(4)]
+        n_chips = len(psdus) * (24 * 88 + 20 * 8)
+
+        encoder_blk = ieee802_11_b.tx_frame_encoder(3, False)
+        head_blk = blocks.head(gr.sizeof_gr_complex, n_chips)
+        dst_blk = blocks.vector_sink_c()
+        self.tb.connect(encoder_blk, head_blk, dst_blk)
+
+        mapper_blk = ieee802_11_b.psdu_mapper(3, False)
+        scramble_blk = ieee802_11_b.scramble(False)
+        code_blk = ieee802_11_b.code_mapper()
+        ref_head_blk = blocks.head(gr.sizeof_gr_complex, n_chips)
+        ref_dst_blk = blocks.vector_sink_c()
+        self.tb.connect(mapper_blk, scramble_blk, code_blk, ref_head_blk, ref_dst_blk)
+
+        for psdu in psdus:
+            blob = pmt.init_u8vector(len(psdu), psdu)
+            encoder_blk.to_basic_block()._post(pmt.intern("psdu in"),
+                                               pmt.cons(pmt.PMT_NIL, blob))
+            mapper_blk.to_basic_block()._post(pmt.intern("psdu in"), blob)
+        self.tb.run()
+
+        self.assertEqual(n_chips, len(dst_blk.data()))
+        self.assertComplexTuplesAlmostEqual(ref_dst_blk.data(), dst_blk.data())
+
+    def test_003_worker_threads(self):
+        # Frames encoded in parallel come out as the serial encoder's
+        psdus = [[(i * 11 + k) & 0xFF for k in range(10 + 7 * i)] for i in range(8)]
+        n_chips = sum(9 * 88 + 6 * 44 + len(p) * 16 for p in psdus)
+
+        sinks = []
+        for n_threads in (0, 3):
+            encoder_blk = ieee802_11_b.tx_frame_encoder(2, True, 64, n_threads)
+            head_blk = blocks.head(gr.sizeof_gr_complex, n_chips)
+            dst_blk = blocks.vector_sink_c()
+            self.tb.connect(encoder_blk, head_blk, dst_blk)
+            for psdu in psdus:
+                blob = pmt.init_u8vector(len(psdu), psdu)
+                encoder_blk.to_basic_block()._post(pmt.intern("psdu in"),
+                                                   pmt.cons(pmt.PMT_NIL, blob))
+            sinks.append(dst_blk)
+        self.tb.run()
+
+        self.assertEqual(n_chips, len(sinks[1].data()))
+        self.assertComplexTuplesAlmostEqual(sinks[0].data(), sinks[1].data())
+        self.assertEqual([t.offset for t in sinks[0].tags()],
+                         [t.offset for t in sinks[1].tags()])
+
+    def test_004_small_output_buffers(self):
+        # Output calls shorter than a frame and not a multiple of the chips
+        # per byte split PSDU bytes across calls
+        psdus = [[(i * 29 + k) & 0xFF for k in range(30 + 5 * i)] for i in range(3)]
+        n_chips = sum(24 * 88 + len(p) * 16 for p in psdus)
+
+        encoder_blk = ieee802_11_b.tx_frame_encoder(2, False)
+        encoder_blk.set_max_noutput_items(37)
+        head_blk = blocks.head(gr.sizeof_gr_complex, n_chips)
+        dst_blk = blocks.vector_sink_c()
+        self.tb.connect(encoder_blk, head_blk, dst_blk)
+
+        mapper_blk = ieee802_11_b.psdu_mapper(2, False)
+        scramble_blk = ieee802_11_b.scramble(False)
+        code_blk = ieee802_11_b.code_mapper()
+        ref_head_blk = blocks.head(gr.sizeof_gr_complex, n_chips)
+        ref_dst_blk = blocks.vector_sink_c()
+        self.tb.connect(mapper_blk, scramble_blk, code_blk, ref_head_blk, ref_dst_blk)
+
+        for psdu in psdus:
+            blob = pmt.init_u8vector(len(psdu), psdu)
+            encoder_blk.to_basic_block()._post(pmt.intern("psdu in"),
+                                               pmt.cons(pmt.PMT_NIL, blob))
+            mapper_blk.to_basic_block()._post(pmt.intern("psdu in"), blob)
+        self.tb.run()
+
+        self.assertEqual(n_chips, len(dst_blk.data()))
+        self.assertComplexTuplesAlmostEqual(ref_dst_blk.data(), dst_blk.data())
+
+    def test_005_oversized_psdu_dropped(self):
+        psdu = [0x33] * 10
+        n_chips = 24 * 88 + len(psdu) * 8
+
+        encoder_blk = ieee802_11_b.tx_frame_encoder(3, False)
+        head_blk = blocks.head(gr.sizeof_gr_complex, n_chips)
+        dst_blk = blocks.vector_sink_c()
+        self.tb.connect(encoder_blk, head_blk, dst_blk)
+
+        for data in ([0x44] * 4096, psdu):
+            blob = pmt.init_u8vector(len(data), data)
+            encoder_blk.to_basic_block()._post(pmt.intern("psdu in"),
+                                               pmt.cons(pmt.PMT_NIL, blob))
+        self.tb.run()
+
+        self.assertEqual(1, encoder_blk.frames_dropped())
+        tags = dst_blk.tags()
+        self.assertEqual(1, len(tags))
+        self.assertEqual(n_chips, pmt.to_long(tags[0].value))
+
+    def test_006_full_queue_drops(self):
+        psdus = [[(i * 13 + k) & 0xFF for k in range(20)] for i in range(5)]
+        n_chips = 2 * (24 * 88 + 20 * 8)
+
+        for queue_depth, n_threads in ((2, 0), (64, 1)):
+            encoder_blk = ieee802_11_b.tx_frame_encoder(3, False, queue_depth, n_threads)
+            head_blk = blocks.head(gr.sizeof_gr_complex, n_chips)
+            dst_blk = blocks.vector_sink_c()
+            tb = gr.top_block()
+            tb.connect(encoder_blk, head_blk, dst_blk)
+
+            # All messages are handled before the first call to work
+            for psdu in psdus:
+                blob = pmt.init_u8vector(len(psdu), psdu)
+                encoder_blk.to_basic_block()._post(pmt.intern("psdu in"),
+                                                   pmt.cons(pmt.PMT_NIL, blob))
+            tb.run()
+
+            self.assertEqual(5, encoder_blk.frames_received())
+            self.assertEqual(5 - encoder_blk.queue_depth(), encoder_blk.frames_dropped())
+            self.assertEqual(n_chips, len(dst_blk.data()))
+
+
+if __name__ == '__main__':
+    gr_unittest.run(qa_tx_frame_encoder)
@@ -11,6 +11,14 @@
 #include "ieee802_11_b/psdu_mapper.h"
 #include "ieee802_11_b/code_mapper.h"
 #include "ieee802_11_b/scramble.h"
+#include "ieee802_11_b/tx_frame_encoder.h"
+#include "ieee802_11_b/barker_despreader.h"
+#include "ieee802_11_b/cck_demapper.h"
+#include "ieee802_11_b/plcp_sync.h"
+#include "ieee802_11_b/phase_expander.h"
+#include "ieee802_11_b/pulse_shaper.h"
+#include "ieee802_11_b/pcap_psdu_source.h"
+#include "ieee802_11_b/multi_tx_encoder.h"
 %}
 
 %include "ieee802_11_b/psdu_mapper.h"
@@ -20,4 +28,20 @@ GR_SWIG_BLOCK_MAGIC2(ieee802_11_b, psdu_mapper);
 GR_SWIG_BLOCK_MAGIC2(ieee802_11_b, code_mapper);
 %include "ieee802_11_b/scramble.h"
 GR_SWIG_BLOCK_MAGIC2(ieee802_11_b, scramble);
+%include "ieee802_11_b/tx_frame_encoder.h"
+GR_SWIG_BLOCK_MAGIC2(ieee802_11_b, tx_frame_encoder);
+%include "ieee802_11_b/barker_despreader.h"
+GR_SWIG_BLOCK_MAGIC2(ieee802_11_b, barker_despreader);
+%include "ieee802_11_b/cck_demapper.h"
+GR_SWIG_BLOCK_MAGIC2(ieee802_11_b, cck_demapper);
+%include "ieee802_11_b/plcp_sync.h"
+GR_SWIG_BLOCK_MAGIC2(ieee802_11_b, plcp_sync);
+%include "ieee802_11_b/phase_expander.h"
+GR_SWIG_BLOCK_MAGIC2(ieee802_11_b, phase_expander);
+%include "ieee802_11_b/pulse_shaper.h"
+GR_SWIG_BLOCK_MAGIC2(ieee802_11_b, pulse_shaper);
+%include "ieee802_11_b/pcap_psdu_source.h"
+GR_SWIG_BLOCK_MAGIC2(ieee802_11_b, pcap_psdu_source);
+%include "ieee802_11_b/multi_tx_encoder.h"
+GR_SWIG_BLOCK_MAGIC2(ieee802_11_b, multi_tx_encoder);
 